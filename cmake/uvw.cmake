@@ -0,0 +1,76 @@
+# uvw_generate(<target> <workspace json>
+#   [NAME <class name>]
+#   [INCLUDES <proc headers>...]
+#   [TYPES <proc type>=<C++ class>...]
+#   [VAR_TYPES <var type>=<C++ type>...])
+#
+# generates a class running the serialized workspace without the registry
+# (see tools/uvw_gen.cpp) & adds it to the target; include "<class name>.h"
+function(uvw_generate target json)
+  cmake_parse_arguments(GEN "" "NAME" "INCLUDES;TYPES;VAR_TYPES" ${ARGN})
+  if(NOT GEN_NAME)
+    get_filename_component(GEN_NAME ${json} NAME_WE)
+  endif()
+  get_filename_component(json_path ${json} ABSOLUTE)
+
+  set(gen_args -n ${GEN_NAME})
+  foreach(inc ${GEN_INCLUDES})
+    list(APPEND gen_args -i ${inc})
+  endforeach()
+  foreach(type ${GEN_TYPES})
+    list(APPEND gen_args -t ${type})
+  endforeach()
+  foreach(type ${GEN_VAR_TYPES})
+    list(APPEND gen_args -v ${type})
+  endforeach()
+
+  # in-tree generator, or the installed one (see uvwConfig.cmake)
+  set(gen_tool uvw_gen)
+  if(NOT TARGET uvw_gen AND TARGET uvw::uvw_gen)
+    set(gen_tool uvw::uvw_gen)
+  endif()
+
+  set(gen_dir ${CMAKE_CURRENT_BINARY_DIR}/uvw_gen)
+  set(gen_base ${gen_dir}/${GEN_NAME})
+  add_custom_command(
+    OUTPUT ${gen_base}.h ${gen_base}.cpp
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${gen_dir}
+    COMMAND ${gen_tool} ${json_path} ${gen_base} ${gen_args}
+    DEPENDS ${gen_tool} ${json_path}
+    COMMENT "Generating ${GEN_NAME} from ${json}"
+  )
+  target_sources(${target} PRIVATE ${gen_base}.cpp)
+  target_include_directories(${target} PRIVATE ${gen_dir})
+endfunction()
+
+# uvw_add_server(<target>
+#   [INCLUDES <proc headers>...]
+#   [TYPES <proc type>[=<C++ class>]...])
+#
+# adds an executable serving workspaces over a Unix domain socket with the
+# given proc types registered (see include/uvw/server.h); run as
+#   <target> <socket path> <name>=<workspace json>...
+function(uvw_add_server target)
+  cmake_parse_arguments(SRV "" "" "INCLUDES;TYPES" ${ARGN})
+
+  set(code "// generated by uvw_add_server\n")
+  string(APPEND code "#include <uvw.h>\n#include <uvw/server.h>\n")
+  foreach(inc ${SRV_INCLUDES})
+    get_filename_component(inc_path ${inc} ABSOLUTE)
+    string(APPEND code "#include \"${inc_path}\"\n")
+  endforeach()
+  string(APPEND code "\nint main(int argc, char** argv)\n{\n")
+  foreach(type ${SRV_TYPES})
+    string(REPLACE "=" ";" type_pair ${type})
+    list(GET type_pair 0 type_name)
+    list(GET type_pair -1 type_class)
+    string(APPEND code "  uvw::ws::reg_proc(\"${type_name}\", ")
+    string(APPEND code "[](){return new ${type_class}();});\n")
+  endforeach()
+  string(APPEND code "  return uvw::Server::main(argc, argv);\n}\n")
+
+  set(src ${CMAKE_CURRENT_BINARY_DIR}/uvw_server/${target}.cpp)
+  file(GENERATE OUTPUT ${src} CONTENT "${code}")
+  add_executable(${target} ${src})
+  target_link_libraries(${target} PRIVATE uvw::uvw)
+endfunction()
@@ -3,11 +3,23 @@
 
 // static "global" containers
 
+std::recursive_mutex uvw::Workspace::mutex_;
 std::unordered_set<uvw::Workspace*> uvw::Workspace::ws_;
 std::unordered_set<uvw::Processor*> uvw::Workspace::procs_;
 std::unordered_map<uvw::Duohash, uvw::Duohash> uvw::Workspace::links_;
 std::unordered_map<uvw::Duohash, uvw::Variable*> uvw::Workspace::vars_;
+uvw::Workspace::Version uvw::Workspace::loose_(new uint64_t(1));
+std::unordered_map<void*, std::unordered_map<uvw::Duohash, uvw::Variable*> >
+  uvw::Workspace::vars_by_procs_;
+std::unordered_map<std::string, std::unordered_set<uvw::Processor*> >
+  uvw::Workspace::procs_by_types_;
 std::map<std::string, std::function<uvw::Processor*()> > uvw::Workspace::lib_;
+std::map<std::string, std::vector<uvw::Processor*> > uvw::Workspace::pool_;
+std::unordered_map<uvw::Duohash, uvw::Workspace::Push>
+  uvw::Workspace::pushes_;
+std::vector<uvw::Duohash> uvw::Workspace::held_;
+std::vector<uvw::Duohash> uvw::Workspace::deltas_;
+const size_t uvw::Workspace::tile_size;
 
 // operator overload
 
@@ -19,12 +31,58 @@ bool uvw::operator==(const uvw::Duohash& lhs, const uvw::Duohash& rhs)
 // Variable fundamental types; can be added to account for more types
 
 bool uvw::Variable::data_pull = true;
+bool uvw::Variable::data_lazy = false;
+uint32_t uvw::Variable::seq_retries = 100000;
+uint64_t uvw::Variable::marks_ = 0;
+std::atomic<uint64_t> uvw::Variable::enabled_epoch_(1);
 
 std::map<std::type_index, std::string> uvw::Variable::type_strs = {
   {std::type_index(typeid(int64_t)), "int64"},
   {std::type_index(typeid(bool)), "bool"},
   {std::type_index(typeid(double)), "double"},
-  {std::type_index(typeid(std::string)), "string"}
+  {std::type_index(typeid(std::string)), "string"},
+  {std::type_index(typeid(uvw::Array<int64_t>)), "int64[]"},
+  {std::type_index(typeid(uvw::Array<double>)), "double[]"}
+};
+
+#include <cstring>
+
+std::map<std::type_index, uvw::StateCodec> uvw::Variable::state_codecs = {
+  {
+    std::type_index(typeid(std::string)),
+    {
+      [](const void* data, std::vector<char>& buf)
+      {
+        auto& str = *((const std::string*)data);
+        uint64_t len = str.size();
+        buf.insert(buf.end(), (const char*)&len, (const char*)&len + 8);
+        buf.insert(buf.end(), str.begin(), str.end());
+      },
+      [](void* data, const char* buf, size_t size) -> size_t
+      {
+        uint64_t len;
+        if (size < 8)
+        {
+          return 0;
+        }
+        std::memcpy(&len, buf, 8);
+        if (size - 8 < len)
+        {
+          return 0;
+        }
+        ((std::string*)data)->assign(buf + 8, len);
+        return 8 + len;
+      }
+    }
+  },
+  {
+    std::type_index(typeid(uvw::Array<int64_t>)),
+    uvw::Array<int64_t>::codec()
+  },
+  {
+    std::type_index(typeid(uvw::Array<double>)),
+    uvw::Array<double>::codec()
+  }
 };
 
 const std::string uvw::Variable::type_str()
@@ -33,59 +91,324 @@ const std::string uvw::Variable::type_str()
     "UNKNOWN" : type_strs[type_index()];
 }
 
+#ifdef UVW_BUILD_STATIC
+// built-in var types; declared extern by uvw.h
+#define UVW_DEFINE_VAR_(T) UVW_INSTANTIATE_VAR(, T)
+UVW_BUILTIN_TYPES(UVW_DEFINE_VAR_)
+#undef UVW_DEFINE_VAR_
+#endif
+
 // Variable impl.
 
 #include <queue>
+#include <thread>
 
-void uvw::Variable::propagate(void* data_src)
+void uvw::Variable::reroot_(const std::vector<uvw::Variable*>& vars)
 {
-  std::queue<uvw::Duohash> key_queue;
-  key_queue.push(key_);
-  while (key_queue.size())
+  // mark the vars & their downstream vars pending
+  uint64_t pending = ++marks_, walking = ++marks_, done = ++marks_;
+  std::vector<uvw::Variable*> affected;
+  for (auto* v : vars)
+  {
+    if (v->mark_ != pending)
+    {
+      v->mark_ = pending;
+      affected.push_back(v);
+    }
+  }
+  for (size_t k = 0; k < affected.size(); k++)
+  {
+    for (const auto& key : affected[k]->incoming_)
+    {
+      auto itr = uvw::Workspace::vars_.find(key);
+      if (itr != uvw::Workspace::vars_.end() &&
+        itr->second->mark_ != pending)
+      {
+        itr->second->mark_ = pending;
+        affected.push_back(itr->second);
+      }
+    }
+  }
+
+  // walk up the pending vars to a head, to a var whose head is known
+  // (resolved or not pending) or back onto the walk (cyclic links)
+  std::vector<uvw::Variable*> path;
+  for (auto* v : affected)
   {
-    auto* v_ = uvw::Workspace::get(key_queue.front());
-    key_queue.pop();
-    if (v_)
+    path.clear();
+    uvw::Variable* u = v;
+    while (u && u->mark_ == pending)
     {
-      v_->data_src_ = data_src;
-      for (auto k : v_->incoming_)
+      u->mark_ = walking;
+      path.push_back(u);
+      u = u->src_var_;
+    }
+    uvw::Variable* root = !u? path.back() :
+      (u->mark_ == walking)? u : u->root_;
+    for (auto* w : path)
+    {
+      w->mark_ = done;
+      w->root_ = root;
+      if (w != root)
+      {
+        w->data_src_ = root->data_ptr_;
+      }
+      else if (w->src_var_)
       {
-        key_queue.push(k);
+        w->data_src_ = nullptr;
       }
+      w->bump_();
+    }
+  }
+}
+
+void uvw::Variable::unlink_(const std::vector<uvw::Variable*>& vars)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  for (auto* v : vars)
+  {
+    if (v->src_var_)
+    {
+      v->src_var_->incoming_.erase(v->key_);
+      v->src_var_->bump_();
+    }
+    v->src_.nullify();
+    v->src_var_ = nullptr;
+    v->data_src_ = nullptr;
+    uvw::Workspace::links_.erase(v->key_);
+  }
+  reroot_(vars);
+  if (data_lazy)
+  {
+    for (auto* v : vars)
+    {
+      v->touch();
     }
   }
 }
 
 bool uvw::Variable::unlink()
 {
-  if (uvw::Workspace::has(src_))
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  if (src_var_)
   {
-    uvw::Workspace::get(src_)->incoming_.erase(key_);
+    src_var_->incoming_.erase(key_);
+    src_var_->bump_();
   }
 
   src_.nullify();
-  // ensure to point downstream to self
-  propagate(data_ptr_);
+  src_var_ = nullptr;
   data_src_ = nullptr;
+  // the var heads its downstream vars
+  reroot_({this});
+  if (data_lazy)
+  {
+    touch();
+  }
 
   return (uvw::Workspace::links_.erase(key_) > 0);
 }
 
 bool uvw::Variable::link(uvw::Variable* src)
 {
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
   if (type_index() != src->type_index())
   {
     unlink();
     return false;
   }
-  // hook up key & src data ptr
+  if (src_var_ && src_var_ != src)
+  {
+    src_var_->incoming_.erase(key_);
+    src_var_->bump_();
+  }
   src_ = uvw::Duohash(src->key());
-
-  // populate downstream/incoming links
-  propagate(src->data_ptr_);
+  src_var_ = src;
   src->incoming_.insert(key_);
+  src->bump_();
+  // point the var & its downstream vars at the new head
+  reroot_({this});
 
   uvw::Workspace::links_[key_] = src_;
+  if (data_lazy)
+  {
+    touch();
+  }
+  return true;
+}
+
+void uvw::Variable::bump_()
+{
+  uvw::Processor* proc_ptr = proc();
+  if (proc_ptr && proc_ptr->version_)
+  {
+    ++*proc_ptr->version_;
+  }
+}
+
+bool uvw::Variable::read_seq_(void* dst, const void* src, size_t size,
+  const std::atomic<uint64_t>& seq)
+{
+  for (uint32_t k = 0; k <= seq_retries; k++)
+  {
+    uint64_t s = seq.load(std::memory_order_acquire);
+    if (!(s & 1))
+    {
+      std::memcpy(dst, src, size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s == seq.load(std::memory_order_relaxed))
+      {
+        return true;
+      }
+    }
+    // spin briefly, then let a preempted writer finish
+    if (k >= 64)
+    {
+      std::this_thread::yield();
+    }
+  }
+  return false;
+}
+
+void uvw::Variable::publish_()
+{
+  // single writer per slot; odd even if a previous writer died mid-store
+  uint64_t seq = data_seq_->load(std::memory_order_relaxed) | 1;
+  data_seq_->store(seq, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(data_pub_, data_ptr_, data_size());
+  data_seq_->store(seq + 1, std::memory_order_release);
+}
+
+void uvw::Variable::moved_()
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  bump_();
+  if (root_ == this && !incoming_.empty())
+  {
+    reroot_({this});
+  }
+}
+
+bool uvw::Variable::evaluate()
+{
+  return uvw::Workspace::evaluate(key_);
+}
+
+void uvw::Variable::touch()
+{
+  uvw::Workspace::touch(key_);
+}
+
+void uvw::Variable::hold()
+{
+  // writes of procs being processed are their own outputs
+  uvw::Processor* proc_ptr = proc();
+  if (held_ || !proc_ptr || proc_ptr->busy_)
+  {
+    return;
+  }
+  held_ = true;
+  hold_();
+  uvw::Workspace::held_.push_back(key_);
+}
+
+void uvw::Variable::mark_delta(uint8_t fields)
+{
+  uvw::Processor* proc_ptr = proc();
+  if (!proc_ptr || proc_ptr->busy_)
+  {
+    return;
+  }
+  if (!(delta_ & delta_listed_))
+  {
+    uvw::Workspace::deltas_.push_back(key_);
+  }
+  delta_ |= fields | delta_listed_;
+}
+
+bool uvw::Variable::push()
+{
+  return uvw::Workspace::push(key_);
+}
+
+size_t uvw::Variable::subscribe(const Callback& callback)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  uvw::Processor* proc_ptr = proc();
+  if (!proc_ptr || !callback)
+  {
+    return 0;
+  }
+  if (!subs_)
+  {
+    subs_.reset(new Subs());
+  }
+  if (!subs_->n)
+  {
+    // the value as of subscribing is the first seen
+    changed_();
+    proc_ptr->watched_++;
+  }
+  subs_->callbacks.push_back({++subs_->id, callback});
+  subs_->n++;
+  return subs_->id;
+}
+
+bool uvw::Variable::unsubscribe(size_t id)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  if (!subs_)
+  {
+    return false;
+  }
+  auto& callbacks = subs_->callbacks;
+  for (auto itr = callbacks.begin(); itr != callbacks.end(); itr++)
+  {
+    if (itr->first != id || !itr->second)
+    {
+      continue;
+    }
+    if (subs_->firing)
+    {
+      itr->second = nullptr;
+    }
+    else
+    {
+      callbacks.erase(itr);
+    }
+    uvw::Processor* proc_ptr = proc();
+    if (--subs_->n == 0 && proc_ptr && proc_ptr->watched_)
+    {
+      proc_ptr->watched_--;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool uvw::Variable::notify()
+{
+  if (!subscribed() || subs_->firing || !changed_())
+  {
+    return false;
+  }
+  // callbacks subscribed while firing are fired from the next change on
+  auto& callbacks = subs_->callbacks;
+  subs_->firing = true;
+  auto itr = callbacks.begin();
+  for (size_t i = 0, n = callbacks.size(); i < n; i++, itr++)
+  {
+    if (itr->second)
+    {
+      itr->second(this);
+    }
+  }
+  subs_->firing = false;
+  for (itr = callbacks.begin(); itr != callbacks.end();)
+  {
+    itr = itr->second? std::next(itr) : callbacks.erase(itr);
+  }
   return true;
 }
 
@@ -100,7 +423,9 @@ uvw::Processor* uvw::Variable::proc()
 
 // Processor impl.
 
-uvw::Processor::Processor(): type_("UNDEFINED")
+uvw::Processor::Processor():
+  type_("UNDEFINED"), stale_(true), busy_(false), shared_(false),
+  watched_(0), version_(uvw::Workspace::loose_)
 {
   uvw::ws::track_(this);
 }
@@ -111,7 +436,9 @@ uvw::Processor::~Processor()
   uvw::ws::untrack_(this);
 }
 
-uvw::Processor::Processor(const uvw::Processor& p)
+uvw::Processor::Processor(const uvw::Processor& p):
+  stale_(true), busy_(false), shared_(false), watched_(0),
+  version_(uvw::Workspace::loose_)
 {
   *this = p;
 }
@@ -131,8 +458,11 @@ uvw::Variable* uvw::Processor::get(const std::string& label)
 
 #include <stack>
 #include <vector>
+#include <algorithm>
 
-uvw::Workspace::Workspace()
+uvw::Workspace::Workspace():
+  version_(new uint64_t(1)), fused_(false), delta_made_(false),
+  delta_version_(0), state_size_(0), state_version_(0)
 {
   track_(this);
 }
@@ -141,16 +471,161 @@ uvw::Workspace::~Workspace()
   clear();
   untrack_(this);
 }
-uvw::Workspace::Workspace(const Workspace& w)
+uvw::Workspace::Workspace(const Workspace& w):
+  version_(new uint64_t(1)), fused_(false), delta_made_(false),
+  delta_version_(0), state_size_(0), state_version_(0)
 {
+  track_(this);
   *this = w;
 }
 uvw::Workspace& uvw::Workspace::operator=(const uvw::Workspace& w)
 {
-  proc_ptrs_ = w.proc_ptrs_;
+  clone(w);
   return *this;
 }
 
+bool uvw::Workspace::clone(const uvw::Workspace& w)
+{
+  if (&w == this)
+  {
+    return true;
+  }
+  clear();
+
+  std::unordered_map<void*, uvw::Processor*> procs_by_srcs;
+  procs_by_srcs.reserve(w.proc_ptrs_.size());
+  proc_ptrs_.reserve(w.proc_ptrs_.size());
+  for (auto* src_ptr : w.proc_ptrs_)
+  {
+    auto* proc_ptr = new_proc(src_ptr->type_);
+    if (!proc_ptr)
+    {
+      std::cerr << "Cannot create proc type '" <<
+        src_ptr->type_ << "'!" << std::endl;
+      return false;
+    }
+    procs_by_srcs[src_ptr] = proc_ptr;
+
+    const auto& src_vars = src_ptr->var_ptrs_;
+    const auto& dst_vars = proc_ptr->var_ptrs_;
+    for (size_t i = 0; i < src_vars.size(); i++)
+    {
+      // vars are usually registered in the same order
+      const auto& label = src_vars[i]->key_.var_str;
+      uvw::Variable* v = (i < dst_vars.size() &&
+        dst_vars[i]->key_.var_str == label)? dst_vars[i] : proc_ptr->get(label);
+      if (!v || !v->assign(src_vars[i]))
+      {
+        std::cerr << "Cannot copy var '" << label << "'!" << std::endl;
+        return false;
+      }
+    }
+    if (!proc_ptr->assign(src_ptr))
+    {
+      std::cerr << "Cannot copy proc type '" <<
+        src_ptr->type_ << "'!" << std::endl;
+      return false;
+    }
+  }
+
+  auto clone_key_ = [&procs_by_srcs](const uvw::Duohash& key)
+  {
+    auto itr = procs_by_srcs.find(key.raw_ptr);
+    return (itr != procs_by_srcs.end())?
+      uvw::Duohash(itr->second, key.var_str) : key;
+  };
+
+  // links into the cloned procs; sources outside of 'w' are shared
+  for (auto* src_ptr : w.proc_ptrs_)
+  {
+    for (auto* v : src_ptr->var_ptrs_)
+    {
+      if (v->src_.is_null())
+      {
+        continue;
+      }
+      auto dst = uvw::Duohash(procs_by_srcs[src_ptr], v->key_.var_str);
+      if (!link(clone_key_(v->src_), dst))
+      {
+        std::cerr << "Cannot link between " << v->src_ <<
+          " & " << dst << std::endl;
+        return false;
+      }
+    }
+  }
+
+  in_ = w.in_.is_null()? w.in_ : clone_key_(w.in_);
+  out_ = w.out_.is_null()? w.out_ : clone_key_(w.out_);
+
+  // map the schedule as is, rather than re-scheduling
+  seq_.reserve(w.seq_.size());
+  for (auto* proc_ptr : w.seq_)
+  {
+    auto itr = procs_by_srcs.find(proc_ptr);
+    if (itr == procs_by_srcs.end())
+    {
+      seq_ = uvw::Workspace::schedule(out_);
+      break;
+    }
+    seq_.push_back(itr->second);
+  }
+  return true;
+}
+
+void uvw::Workspace::Stamp::make(const std::vector<uvw::Processor*>& procs)
+{
+  versions.clear();
+  const uint64_t* last = nullptr;
+  for (auto* proc_ptr : procs)
+  {
+    if (!exists_(proc_ptr) || proc_ptr->version_.get() == last)
+    {
+      continue;
+    }
+    const auto& version = proc_ptr->version_;
+    last = version.get();
+    bool seen = false;
+    for (const auto& v : versions)
+    {
+      seen = seen || (v.first == version);
+    }
+    if (!seen)
+    {
+      versions.push_back({version, *version});
+    }
+  }
+  made = true;
+}
+
+void uvw::Workspace::swap(uvw::Workspace& w)
+{
+  if (&w == this)
+  {
+    return;
+  }
+  // procs keep their versions, so plans stay valid
+  version_.swap(w.version_);
+  proc_ptrs_.swap(w.proc_ptrs_);
+  procs_set_.swap(w.procs_set_);
+  std::swap(in_, w.in_);
+  std::swap(out_, w.out_);
+  seq_.swap(w.seq_);
+  std::swap(pulls_, w.pulls_);
+  std::swap(prune_, w.prune_);
+  steps_.swap(w.steps_);
+  std::swap(fused_, w.fused_);
+  std::swap(fuse_stamp_, w.fuse_stamp_);
+  std::swap(delta_made_, w.delta_made_);
+  std::swap(delta_version_, w.delta_version_);
+  delta_index_.swap(w.delta_index_);
+  slabs_.swap(w.slabs_);
+  packed_vars_.swap(w.packed_vars_);
+  state_runs_.swap(w.state_runs_);
+  state_codecs_.swap(w.state_codecs_);
+  std::swap(state_size_, w.state_size_);
+  std::swap(state_version_, w.state_version_);
+}
+
 std::string uvw::Workspace::stats()
 {
   std::string res("Stats - procs: ");
@@ -208,6 +683,7 @@ std::string uvw::Workspace::summary()
 
 bool uvw::Workspace::link(const uvw::Duohash& src, const uvw::Duohash& dst)
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!uvw::Workspace::has(src) || !uvw::Workspace::has(dst))
   {
     return false;
@@ -228,6 +704,7 @@ bool uvw::Workspace::track_(uvw::Processor* proc_ptr)
   if (!uvw::Workspace::exists_(proc_ptr))
   {
     uvw::Workspace::procs_.insert(proc_ptr);
+    uvw::Workspace::procs_by_types_[proc_ptr->type_].insert(proc_ptr);
     return true;
   }
   return false;
@@ -235,17 +712,134 @@ bool uvw::Workspace::track_(uvw::Processor* proc_ptr)
 
 bool uvw::Workspace::untrack_(uvw::Processor* proc_ptr)
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (uvw::Workspace::exists_(proc_ptr))
   {
     for (const auto& key : proc_ptr->var_keys())
     {
       uvw::Workspace::del(key);
     }
+    auto itr = procs_by_types_.find(proc_ptr->type_);
+    if (itr != procs_by_types_.end())
+    {
+      itr->second.erase(proc_ptr);
+      if (itr->second.empty())
+      {
+        procs_by_types_.erase(itr);
+      }
+    }
     return uvw::Workspace::procs_.erase(proc_ptr);
   }
   return false;
 }
 
+void uvw::Workspace::untrack_(const std::vector<uvw::Processor*>& proc_ptrs)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::vector<uvw::Variable*> vars;
+    for (auto* proc_ptr : proc_ptrs)
+    {
+      if (exists_(proc_ptr))
+      {
+        vars.insert(vars.end(), proc_ptr->var_ptrs_.begin(),
+          proc_ptr->var_ptrs_.end());
+      }
+    }
+    uvw::Variable::unlink_(vars);
+    // what is left incoming reads from the procs but is not theirs
+    std::vector<uvw::Variable*> dsts;
+    for (auto* v_ : vars)
+    {
+      for (const auto& key : v_->incoming_)
+      {
+        uvw::Variable* dst = get(key);
+        if (dst)
+        {
+          dsts.push_back(dst);
+        }
+      }
+    }
+    uvw::Variable::unlink_(dsts);
+  }
+
+  // unregister a chunk of procs per lock, so other workspaces are not
+  // held up for long (see Reload)
+  const size_t chunk = 1024;
+  for (size_t i = 0; i < proc_ptrs.size(); i += chunk)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    size_t end = std::min(i + chunk, proc_ptrs.size());
+    for (size_t j = i; j < end; j++)
+    {
+      uvw::Processor* proc_ptr = proc_ptrs[j];
+      if (!exists_(proc_ptr))
+      {
+        continue;
+      }
+      for (auto* v_ : proc_ptr->var_ptrs_)
+      {
+        if (pushes_.size())
+        {
+          pushes_.erase(v_->key_);
+        }
+        vars_.erase(v_->key_);
+      }
+      ++*proc_ptr->version_;
+      vars_by_procs_.erase(proc_ptr);
+      auto itr = procs_by_types_.find(proc_ptr->type_);
+      if (itr != procs_by_types_.end())
+      {
+        itr->second.erase(proc_ptr);
+        if (itr->second.empty())
+        {
+          procs_by_types_.erase(itr);
+        }
+      }
+      procs_.erase(proc_ptr);
+    }
+  }
+}
+
+void uvw::Workspace::retype_(
+  uvw::Processor* proc_ptr,
+  const std::string& proc_type
+)
+{
+  if (uvw::Workspace::exists_(proc_ptr))
+  {
+    auto itr = procs_by_types_.find(proc_ptr->type_);
+    if (itr != procs_by_types_.end())
+    {
+      itr->second.erase(proc_ptr);
+      if (itr->second.empty())
+      {
+        procs_by_types_.erase(itr);
+      }
+    }
+    procs_by_types_[proc_type].insert(proc_ptr);
+  }
+  proc_ptr->type_ = proc_type;
+}
+
+void uvw::Workspace::index_var_(const uvw::Duohash& key, uvw::Variable* v)
+{
+  vars_by_procs_[key.raw_ptr][key] = v;
+}
+
+void uvw::Workspace::unindex_var_(const uvw::Duohash& key)
+{
+  auto itr = vars_by_procs_.find(key.raw_ptr);
+  if (itr != vars_by_procs_.end())
+  {
+    itr->second.erase(key);
+    if (itr->second.empty())
+    {
+      vars_by_procs_.erase(itr);
+    }
+  }
+}
+
 bool uvw::Workspace::exists_(uvw::Workspace* ws_ptr)
 {
   return (
@@ -275,15 +869,23 @@ bool uvw::Workspace::untrack_(uvw::Workspace* ws_ptr)
 
 void uvw::Workspace::clear()
 {
-  auto itr = proc_ptrs_.begin();
-  while (itr != proc_ptrs_.end())
+  unpack();
+  unfuse();
+  // untrack all procs first so chains are re-resolved once, not per proc;
+  // the lock is held per step, not throughout (see Reload)
+  untrack_(proc_ptrs_);
+  for (auto* proc_ptr : proc_ptrs_)
   {
-    untrack_(*itr);
-    //delete (*itr);
-    itr = proc_ptrs_.erase(itr);
+    recycle_(proc_ptr);
+    proc_ptr->version_ = loose_;
+    //delete proc_ptr;
   }
+  ++*version_;
+  proc_ptrs_.clear();
   seq_.clear();
-  procs_by_keys_.clear();
+  procs_set_.clear();
+  delta_made_ = false;
+  delta_index_.clear();
   in_.nullify();
   out_.nullify();
 }
@@ -295,20 +897,85 @@ bool uvw::Workspace::clear_proc_lib()
   {
     return false;
   }
-  lib_.clear();
+  for (auto& itr : pool_)
+  {
+    for (auto* proc_ptr : itr.second)
+    {
+      delete proc_ptr;
+    }
+  }
+  pool_.clear();
+  lib_.clear();
+  return true;
+}
+
+size_t uvw::Workspace::pool_size(const std::string& proc_type)
+{
+  auto itr = pool_.find(proc_type);
+  return (itr != pool_.end())? itr->second.size() : 0;
+}
+
+bool uvw::Workspace::recycle_(uvw::Processor* proc_ptr)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (exists_(proc_ptr) || !proc_ptr->reset())
+  {
+    return false;
+  }
+  // drop residual link states so the proc is re-registered clean, & move
+  // values back from external storage (placements, shared stores) which
+  // may be released while the proc is pooled
+  for (auto* v_ : proc_ptr->var_ptrs_)
+  {
+    v_->src_.nullify();
+    v_->src_var_ = nullptr;
+    v_->incoming_.clear();
+    v_->data_src_ = nullptr;
+    v_->rebind(nullptr);
+    v_->data_seq_ = nullptr;
+    v_->data_pub_ = nullptr;
+    v_->subs_.reset();
+    v_->delta_ = 0;
+  }
+  proc_ptr->shared_ = false;
+  proc_ptr->watched_ = 0;
+  pool_[proc_ptr->type_].push_back(proc_ptr);
   return true;
 }
 
+uvw::Processor* uvw::Workspace::reuse_(const std::string& proc_type)
+{
+  auto itr = pool_.find(proc_type);
+  if (itr == pool_.end() || itr->second.empty())
+  {
+    return nullptr;
+  }
+  uvw::Processor* proc_ptr = itr->second.back();
+  itr->second.pop_back();
+
+  // re-register proc & vars without re-initializing
+  track_(proc_ptr);
+  for (auto* v_ : proc_ptr->var_ptrs_)
+  {
+    vars_[v_->key_] = v_;
+    index_var_(v_->key_, v_);
+  }
+  ++*proc_ptr->version_;
+  proc_ptr->stale_ = true;
+  return proc_ptr;
+}
+
 uvw::Processor* uvw::Workspace::new_proc(const std::string& proc_type)
 {
   uvw::Processor* proc_ptr = uvw::Workspace::create_proc(proc_type);
   if (proc_ptr)
   {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    ++*proc_ptr->version_;
+    proc_ptr->version_ = version_;
+    ++*version_;
     proc_ptrs_.push_back(proc_ptr);
-    for (const auto& key : proc_ptr->var_keys())
-    {
-      procs_by_keys_[key] = proc_ptr;
-    }
+    procs_set_.insert(proc_ptr);
   }
   return proc_ptr;
 }
@@ -328,15 +995,35 @@ bool uvw::Workspace::reg_proc(
 
 bool uvw::Workspace::has_var(const uvw::Duohash& key)
 {
-  return (procs_by_keys_.find(key) != procs_by_keys_.end());
+  // the key names its proc; one lookup per proc, not per var
+  auto itr = procs_set_.find((uvw::Processor*)key.raw_ptr);
+  if (itr == procs_set_.end())
+  {
+    return false;
+  }
+  for (const auto& var_key : (*itr)->var_keys_)
+  {
+    if (var_key == key)
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
 uvw::Processor* uvw::Workspace::create_proc(const std::string& proc_type)
 {
+  // procs register themselves & their vars on construction
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (uvw::Workspace::lib_.find(proc_type) != uvw::Workspace::lib_.end())
   {
-    uvw::Processor* proc = uvw::Workspace::lib_[proc_type]();
-    proc->type_ = proc_type;
+    uvw::Processor* proc = uvw::Workspace::reuse_(proc_type);
+    if (proc)
+    {
+      return proc;
+    }
+    proc = uvw::Workspace::lib_[proc_type]();
+    retype_(proc, proc_type);
     if (proc->initialize())
     {
       return proc;
@@ -346,43 +1033,27 @@ uvw::Processor* uvw::Workspace::create_proc(const std::string& proc_type)
   return nullptr;
 }
 
-std::unordered_map<uvw::Duohash, uvw::Variable*>
+uvw::Range<std::unordered_map<uvw::Duohash, uvw::Variable*> >
   uvw::Workspace::vars(uvw::Processor* proc_ptr)
 {
   if (proc_ptr == nullptr)
   {
-    return Workspace::vars_;
+    return &Workspace::vars_;
   }
-
-  std::unordered_map<uvw::Duohash, uvw::Variable*> res;
-  for (auto itr : Workspace::vars_)
-  {
-    if (itr.second->proc() == proc_ptr)
-    {
-      res[itr.first] = itr.second;
-    }
-  }
-  return res;
+  auto itr = Workspace::vars_by_procs_.find(proc_ptr);
+  return (itr != Workspace::vars_by_procs_.end())? &itr->second : nullptr;
 }
 
-std::unordered_set<uvw::Processor*> uvw::Workspace::procs(
+uvw::Range<std::unordered_set<uvw::Processor*> > uvw::Workspace::procs(
   const std::string& proc_type
 )
 {
   if (proc_type.empty())
   {
-    return Workspace::procs_;
-  }
-
-  std::unordered_set<uvw::Processor*> res;
-  for (auto* ptr : Workspace::procs_)
-  {
-    if (ptr->type_ == proc_type)
-    {
-      res.insert(ptr);
-    }
+    return &Workspace::procs_;
   }
-  return res;
+  auto itr = Workspace::procs_by_types_.find(proc_type);
+  return (itr != Workspace::procs_by_types_.end())? &itr->second : nullptr;
 }
 
 std::vector<uvw::Processor*>
@@ -406,34 +1077,27 @@ std::vector<uvw::Processor*>
   std::stack<uvw::Processor*> proc_stack;
   proc_stack.push(proc);
 
-  std::stack<uvw::Duohash> stack_keys;
+  // srcs are followed by pointer; links are kept in sync with the
+  // registry, so no key lookups are needed per var
   while (proc_queue.size())
   {
     proc = proc_queue.front();
     proc_queue.pop();
 
-    for (const auto& var_key : proc->var_keys())
+    for (auto* var : proc->var_ptrs_)
     {
-      if (!has(var_key))
-      {
-        continue;
-      }
-      uvw::Variable* var = vars_[var_key];
-
-      if (has(var->src()))
+      uvw::Processor* src_proc =
+        var->src_var_? var->src_var_->proc() : nullptr;
+      if (src_proc)
       {
-        uvw::Variable* src = vars_[var->src()];
-        uvw::Processor* src_proc = src->proc();
-        if (src_proc)
-        {
-          proc_queue.push(src_proc);
-          proc_stack.push(src_proc);
-        }
+        proc_queue.push(src_proc);
+        proc_stack.push(src_proc);
       }
     }
   }
 
   std::unordered_set<void*> visited_procs;
+  visited_procs.reserve(proc_stack.size());
 
   while (proc_stack.size())
   {
@@ -453,8 +1117,23 @@ bool uvw::Workspace::execute(
   bool preprocess
 )
 {
-  for (uvw::Processor* proc_ptr : seq)
+  return execute_(seq, nullptr, preprocess);
+}
+
+bool uvw::Workspace::execute_(
+  const std::vector<uvw::Processor*>& seq,
+  Pulls* pulls,
+  bool preprocess,
+  const std::vector<char>* skip
+)
+{
+  for (size_t i = 0; i < seq.size(); i++)
   {
+    if (skip && (*skip)[i])
+    {
+      continue;
+    }
+    uvw::Processor* proc_ptr = seq[i];
     /* NOTE: a seq can only be considered valid if proc linkage 
       remains unchanged; some form of revoke mechanism is needed
       if we want to guarantee the validity of a seq */
@@ -463,27 +1142,32 @@ bool uvw::Workspace::execute(
       return false;
     }
 
-    if (uvw::Variable::data_pull)
+    if (uvw::Variable::data_pull && pulls)
     {
-      for (auto& var_key : proc_ptr->var_keys_)
+      // re-plan if links changed, including by procs processed so far
+      if (!pulls->stamp.valid() || pulls->procs.size() != seq.size() + 1)
       {
-        uvw::Variable* v_ = vars_[var_key];
-        if (has(v_->src()))
-        {
-          v_->pull();
-        }
+        plan_pulls_(seq, *pulls);
+      }
+      if (!pull_(*pulls, i))
+      {
+        return false;
       }
     }
-
-    if (preprocess)
+    else if (uvw::Variable::data_pull)
     {
-      if (!proc_ptr->preprocess())
+      for (auto* v_ : proc_ptr->var_ptrs_)
       {
-        return false;
+        if (v_->src_data_() && !v_->pull())
+        {
+          std::cerr << "Cannot read shared var " << v_->key() << "!" <<
+            std::endl;
+          return false;
+        }
       }
     }
 
-    if (!proc_ptr->process(preprocess))
+    if (!process_(proc_ptr, preprocess))
     {
       return false;
     }
@@ -492,225 +1176,2516 @@ bool uvw::Workspace::execute(
   return true;
 }
 
-bool uvw::Workspace::set_input(const Duohash& key)
+bool uvw::Workspace::process_(uvw::Processor* proc_ptr, bool preprocess,
+  bool notify)
 {
-  if (has_var(key))
+  // mark busy so lazy reads within the proc do not re-enter it
+  proc_ptr->busy_ = true;
+  bool res = (!preprocess || proc_ptr->preprocess()) &&
+    proc_ptr->process(preprocess);
+  if (proc_ptr->shared_)
   {
-    in_ = key;
-    return true;
+    write_shared_(proc_ptr);
   }
-  return false;
-}
-
-bool uvw::Workspace::set_output(const Duohash& key)
-{
-  seq_.clear();
-  if (has_var(key))
+  proc_ptr->busy_ = false;
+  if (res)
   {
-    out_ = key;
-    seq_ = uvw::Workspace::schedule(out_);
-    return (seq_.size() > 0);
+    proc_ptr->stale_ = false;
+    if (notify && proc_ptr->watched_)
+    {
+      notify_(proc_ptr);
+    }
   }
-  return false;
-}
-
-bool uvw::Workspace::process(bool preprocess)
-{
-  return uvw::Workspace::execute(seq_, preprocess);
+  return res;
 }
 
-// json
-
-bool uvw::Workspace::from_str(const std::string& str)
+void uvw::Workspace::notify_(uvw::Processor* proc_ptr)
 {
-  json data;
-  std::string err = picojson::parse(data, str);
-  if (!err.empty())
+  for (auto* v_ : proc_ptr->var_ptrs_)
   {
-    std::cerr << err << std::endl;
-    return false;
+    if (v_->subscribed())
+    {
+      v_->notify();
+    }
   }
-  return from_json(data);
 }
 
-json uvw::Workspace::to_json()
+namespace
 {
-  if (!proc_ptrs_.size())
+  template<size_t N>
+  void copy_raw_(void* const* dsts, const void* const* srcs, size_t n)
   {
-    return json();
-  }
-
-  json::object data_obj;
-  std::unordered_map<void*, int64_t> indices_by_procs;
-  json::array proc_list;
-  for (auto* proc_ptr : proc_ptrs_)
-  {
-    int64_t index = indices_by_procs.size();
-    indices_by_procs[proc_ptr] = index;
-
-    auto proc_obj = proc_ptr->to_json().get<json::object>();
-    proc_obj["index"] = json(index);
-    proc_list.push_back(json(proc_obj));
+    for (size_t i = 0; i < n; i++)
+    {
+      std::memcpy(dsts[i], srcs[i], N);
+    }
   }
-  data_obj["procs"] = json(proc_list);
-
-  auto is_indexed_ = [&indices_by_procs](void* ptr)
-  {
-    return (indices_by_procs.find(ptr) != indices_by_procs.end());
-  };
 
-  json::array link_list;
-  for (const auto& itr : links_)
+  void copy_raw_(void* const* dsts, const void* const* srcs, size_t n,
+    size_t size)
   {
-    if (is_indexed_(itr.first.raw_ptr) || is_indexed_(itr.second.raw_ptr))
-    {
-      json::object var_obj;
-      json::object src_obj;
-      var_obj["index"] = json(indices_by_procs[itr.first.raw_ptr]);
-      var_obj["label"] = json(itr.first.var_str);
-      src_obj["index"] = json(indices_by_procs[itr.second.raw_ptr]);
-      src_obj["label"] = json(itr.second.var_str);
-      json::object link_obj;
-      link_obj["var"] = json(var_obj);
-      link_obj["src"] = json(src_obj);
-      link_list.push_back(json(link_obj));
-    }
-    else
+    switch (size)
     {
-      // neither is in the ws scope...
+      case 1: copy_raw_<1>(dsts, srcs, n); break;
+      case 4: copy_raw_<4>(dsts, srcs, n); break;
+      case 8: copy_raw_<8>(dsts, srcs, n); break;
+      case 16: copy_raw_<16>(dsts, srcs, n); break;
+      default:
+        for (size_t i = 0; i < n; i++)
+        {
+          std::memcpy(dsts[i], srcs[i], size);
+        }
     }
   }
-  data_obj["links"] = json(link_list);
+};
 
-  if (has_var(in_) && is_indexed_(in_.raw_ptr))
+void uvw::Workspace::plan_pulls_(
+  const std::vector<uvw::Processor*>& seq,
+  Pulls& pulls
+)
+{
+  struct Copy
   {
-    json::object in_obj;
-    in_obj["index"] = json(indices_by_procs[in_.raw_ptr]);
-    in_obj["label"] = json(in_.var_str);
-    data_obj["in"] = json(in_obj);
-  }
-  if (has_var(out_) && is_indexed_(out_.raw_ptr))
+    char* dst;
+    const char* src;
+    size_t size;
+    uvw::Variable* var;
+  };
+  std::vector<Copy> raws, typed;
+
+  pulls.stamp.make(seq);
+  pulls.ops.clear();
+  pulls.dsts.clear();
+  pulls.srcs.clear();
+  pulls.procs.assign(1, 0);
+  auto push_op_ = [&pulls](uvw::Variable::CopyLoop loop, size_t size,
+    size_t begin, uvw::Variable* var)
   {
-    json::object out_obj;
-    out_obj["index"] = json(indices_by_procs[out_.raw_ptr]);
-    out_obj["label"] = json(out_.var_str);
-    data_obj["out"] = json(out_obj);
-  }
-  return json(data_obj);
-}
-
-bool uvw::Workspace::from_json(json& data)
-{
-  auto& data_obj = data.get<json::object>();
-  std::unordered_map<int64_t, void*> procs_by_indices;
+    pulls.ops.push_back({loop, size, begin, pulls.dsts.size() - begin, var});
+  };
 
-  if (data_obj.find("procs") != data_obj.end() &&
-        data_obj["procs"].is<json::array>())
+  for (auto* proc_ptr : seq)
   {
-    for (auto& data_itr : data_obj["procs"].get<json::array>())
+    if (!exists_(proc_ptr))
     {
-      auto& proc_obj = data_itr.get<json::object>();
-      auto proc_type = proc_obj["type"].get<std::string>();
-      auto* proc_ptr = new_proc(proc_type);
-      if (!proc_ptr)
+      pulls.procs.push_back(pulls.ops.size());
+      continue;
+    }
+    raws.clear();
+    typed.clear();
+    for (auto* v : proc_ptr->var_ptrs_)
+    {
+      if (!v->src_data_() || v->data_src_ == v->data_ptr_)
       {
-        std::cerr << "Cannot create proc type '" <<
-          proc_type << "'!" << std::endl;
-        return false;
+        continue;
       }
-
-      procs_by_indices[procs_by_indices.size()] = proc_ptr;
-      if (!proc_ptr->from_json(data_itr))
+      if (v->data_seq_)
       {
-        return false;
+        push_op_(nullptr, 0, pulls.dsts.size(), v);
+        continue;
       }
+      Copy c = {(char*)v->data_ptr_, (const char*)v->data_src_,
+        v->data_size(), v};
+      (v->is_trivial()? raws : typed).push_back(c);
     }
-  }
-
-  auto has_index_ = [&procs_by_indices](int64_t index)
-  {
-    return (procs_by_indices.find(index) !=
-      procs_by_indices.end());
-  };
 
-  // intra-links amongst ws procs/vars
-  if (data_obj.find("links") != data_obj.end() &&
-        data_obj["links"].is<json::array>())
-  {
-    for (auto& data_itr : data_obj["links"].get<json::array>())
+    // raw copies adjacent in both dsts & srcs are merged into single runs,
+    // then grouped by size
+    std::sort(raws.begin(), raws.end(),
+      [](const Copy& a, const Copy& b) {return a.dst < b.dst;});
+    size_t m = 0;
+    for (size_t k = 0; k < raws.size(); k++)
     {
-      auto& link_obj = data_itr.get<json::object>();
-      auto& var_obj = link_obj["var"].get<json::object>();
-      auto& src_obj = link_obj["src"].get<json::object>();
-      auto var_index = var_obj["index"].get<int64_t>();
-      auto src_index = src_obj["index"].get<int64_t>();
-      if (!has_index_(var_index) || !has_index_(src_index))
+      if (m && raws[m - 1].dst + raws[m - 1].size == raws[k].dst &&
+            raws[m - 1].src + raws[m - 1].size == raws[k].src)
       {
-        std::cout << "Cannot find proc index " << var_index <<
-          " or " << src_index << "! Skipping..." << std::endl;
+        raws[m - 1].size += raws[k].size;
         continue;
       }
-      auto* p = procs_by_indices[var_index];
-      auto* q = procs_by_indices[src_index];
-      uvw::Duohash dst(p, var_obj["label"].get<std::string>());
-      uvw::Duohash src(q, src_obj["label"].get<std::string>());
-      if (!link(src, dst))
+      raws[m++] = raws[k];
+    }
+    raws.resize(m);
+    std::stable_sort(raws.begin(), raws.end(),
+      [](const Copy& a, const Copy& b) {return a.size < b.size;});
+    for (size_t k = 0, j; k < raws.size(); k = j)
+    {
+      size_t begin = pulls.dsts.size();
+      for (j = k; j < raws.size() && raws[j].size == raws[k].size; j++)
       {
-        std::cerr << "Cannot link between " << src << " & " << dst << std::endl;
-        return false;
+        pulls.dsts.push_back(raws[j].dst);
+        pulls.srcs.push_back(raws[j].src);
       }
+      push_op_(nullptr, raws[k].size, begin, nullptr);
     }
-  }
 
-  if (data_obj.find("in") != data_obj.end())
-  {
-    auto& in_obj = data_obj["in"].get<json::object>();
-    auto in_index = in_obj["index"].get<int64_t>();
-    if (has_index_(in_index))
+    // others in typed loops per type
+    std::stable_sort(typed.begin(), typed.end(),
+      [](const Copy& a, const Copy& b)
+      {
+        return a.var->type_index() < b.var->type_index();
+      });
+    for (size_t k = 0, j; k < typed.size(); k = j)
     {
-      auto* p = procs_by_indices[in_index];
-      auto k_in = uvw::Duohash(p, in_obj["label"].get<std::string>());
-      if (!set_input(k_in))
+      size_t begin = pulls.dsts.size();
+      auto type = typed[k].var->type_index();
+      for (j = k; j < typed.size() && typed[j].var->type_index() == type; j++)
       {
-        std::cerr << "Cannot set input " << k_in << "!" << std::endl;
+        pulls.dsts.push_back(typed[j].dst);
+        pulls.srcs.push_back(typed[j].src);
       }
+      push_op_(typed[k].var->copy_loop(), 0, begin, nullptr);
     }
-    else
-    {
-      std::cerr << "Cannot find in index " << in_index << "!" << std::endl;
-    }
+    pulls.procs.push_back(pulls.ops.size());
   }
-  if (data_obj.find("out") != data_obj.end())
+}
+
+bool uvw::Workspace::pull_(Pulls& pulls, size_t index)
+{
+  for (size_t k = pulls.procs[index]; k < pulls.procs[index + 1]; k++)
   {
-    auto& out_obj = data_obj["out"].get<json::object>();
-    auto out_index = out_obj["index"].get<int64_t>();
-    if (has_index_(out_index))
+    auto& op = pulls.ops[k];
+    if (op.var)
     {
-      auto* q = procs_by_indices[out_index];
-      auto k_out = uvw::Duohash(q, out_obj["label"].get<std::string>());
-      if (!set_output(k_out))
+      if (!op.var->pull())
       {
-        std::cerr << "Cannot set output " << k_out << "!" << std::endl;
+        std::cerr << "Cannot read shared var " << op.var->key() << "!" <<
+          std::endl;
+        return false;
       }
     }
+    else if (op.loop)
+    {
+      op.loop(&pulls.dsts[op.begin], &pulls.srcs[op.begin], op.n);
+    }
     else
     {
-      std::cerr << "Cannot find out index " << out_index << "!" << std::endl;
+      copy_raw_(&pulls.dsts[op.begin], &pulls.srcs[op.begin], op.n, op.size);
     }
   }
   return true;
 }
 
-json uvw::Processor::to_json()
+void uvw::Workspace::write_shared_(uvw::Processor* proc_ptr)
 {
-  json::object data_obj;
-  data_obj["type"] = json(type_);
-  json::array var_list;
-  for (const auto& key : var_keys())
+  for (auto* v_ : proc_ptr->var_ptrs_)
   {
-    if (get(key.var_str))
+    if (v_->data_pub_)
     {
-      var_list.push_back(json(get(key.var_str)->to_json()));
+      v_->publish_();
+    }
+  }
+}
+
+void uvw::Workspace::settle_()
+{
+  // holds taken from here on start a new list
+  std::vector<uvw::Duohash> held;
+  held.swap(held_);
+  for (auto& key : held)
+  {
+    // keys of erased vars are either gone or reused by vars not held
+    auto itr = vars_.find(key);
+    if (itr == vars_.end() || !itr->second->held_)
+    {
+      continue;
+    }
+    itr->second->held_ = false;
+    if (itr->second->drifted_())
+    {
+      itr->second->mark_delta(uvw::Variable::DELTA_VALUE);
+      touch(key);
+    }
+  }
+}
+
+bool uvw::Workspace::evaluate(const uvw::Duohash& key, bool preprocess)
+{
+  if (held_.size())
+  {
+    settle_();
+  }
+  if (!has(key))
+  {
+    return false;
+  }
+  uvw::Processor* proc = vars_[key]->proc();
+  if (!proc || !exists_(proc))
+  {
+    return false;
+  }
+  if (proc->busy_)
+  {
+    // re-entrant read from within a processing proc
+    return true;
+  }
+
+  // iterative post-order walk over stale upstream procs; busy procs are
+  // either pending on the stack or currently processing, hence skipped
+  std::vector<uvw::Processor*> proc_stack;
+  proc_stack.push_back(proc);
+  while (proc_stack.size())
+  {
+    proc = proc_stack.back();
+    if (!proc->stale_)
+    {
+      proc_stack.pop_back();
+      continue;
+    }
+
+    if (!proc->busy_)
+    {
+      proc->busy_ = true;
+      for (auto& var_key : proc->var_keys_)
+      {
+        uvw::Variable* v_ = vars_[var_key];
+        if (has(v_->src()))
+        {
+          uvw::Processor* src_proc = vars_[v_->src()]->proc();
+          if (src_proc && src_proc->stale_ && !src_proc->busy_ &&
+                exists_(src_proc))
+          {
+            proc_stack.push_back(src_proc);
+          }
+        }
+      }
+      continue;
+    }
+
+    // upstream procs are up-to-date; pull & process
+    proc_stack.pop_back();
+    bool pulled = true;
+    if (uvw::Variable::data_pull)
+    {
+      for (auto* v_ : proc->var_ptrs_)
+      {
+        if (v_->src_data_() && !v_->pull())
+        {
+          std::cerr << "Cannot read shared var " << v_->key() << "!" <<
+            std::endl;
+          pulled = false;
+          break;
+        }
+      }
+    }
+    bool res = pulled && (!preprocess || proc->preprocess()) &&
+      proc->process(preprocess);
+    if (proc->shared_)
+    {
+      write_shared_(proc);
+    }
+    proc->busy_ = false;
+    if (!res)
+    {
+      for (auto* p : proc_stack)
+      {
+        p->busy_ = false;
+      }
+      return false;
+    }
+    proc->stale_ = false;
+    if (proc->watched_)
+    {
+      notify_(proc);
+    }
+  }
+  return true;
+}
+
+void uvw::Workspace::touch(const uvw::Duohash& key)
+{
+  if (!has(key))
+  {
+    return;
+  }
+  uvw::Processor* proc = vars_[key]->proc();
+  if (!proc || !exists_(proc))
+  {
+    return;
+  }
+
+  // always walk the touched proc's downstream; stop at procs already stale
+  std::queue<uvw::Processor*> proc_queue;
+  proc->stale_ = true;
+  proc_queue.push(proc);
+  while (proc_queue.size())
+  {
+    proc = proc_queue.front();
+    proc_queue.pop();
+    for (auto& var_key : proc->var_keys_)
+    {
+      for (auto& dst_key : vars_[var_key]->incoming_)
+      {
+        uvw::Processor* dst_proc = has(dst_key)?
+          vars_[dst_key]->proc() : nullptr;
+        if (dst_proc && !dst_proc->stale_)
+        {
+          dst_proc->stale_ = true;
+          proc_queue.push(dst_proc);
+        }
+      }
+    }
+  }
+}
+
+bool uvw::Workspace::push(const uvw::Duohash& key, bool preprocess)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (!has(key))
+  {
+    return false;
+  }
+  // the written value itself
+  vars_[key]->notify();
+
+  // re-planned once links or the vars of the procs reached change
+  auto itr = pushes_.find(key);
+  if (itr == pushes_.end() || !itr->second.stamp.valid())
+  {
+    itr = pushes_.emplace(key, Push()).first;
+    itr->second = Push();
+    if (!plan_push_(key, itr->second))
+    {
+      pushes_.erase(itr);
+      return false;
+    }
+    itr->second.stamp.make(itr->second.seq);
+  }
+  return execute_(itr->second.seq, &itr->second.pulls, preprocess);
+}
+
+bool uvw::Workspace::plan_push_(const uvw::Duohash& key, Push& push)
+{
+  uvw::Processor* root = vars_[key]->proc();
+  if (!root || !exists_(root))
+  {
+    return false;
+  }
+
+  // procs downstream of the var's proc as touch walks them, with the links
+  // between them
+  std::vector<uvw::Processor*> reached = {root};
+  std::unordered_map<uvw::Processor*, size_t> ins = {{root, 0}};
+  std::vector<std::vector<uvw::Processor*> > outs(1);
+  for (size_t k = 0; k < reached.size(); k++)
+  {
+    for (auto* v_ : reached[k]->var_ptrs_)
+    {
+      for (auto& dst_key : v_->incoming_)
+      {
+        uvw::Processor* dst_proc = has(dst_key)?
+          vars_[dst_key]->proc() : nullptr;
+        if (!dst_proc || dst_proc == reached[k] || !exists_(dst_proc))
+        {
+          continue;
+        }
+        if (dst_proc == root)
+        {
+          std::cerr << "Cannot push " << key << " through cyclic links!" <<
+            std::endl;
+          return false;
+        }
+        if (ins.find(dst_proc) == ins.end())
+        {
+          ins[dst_proc] = 0;
+          reached.push_back(dst_proc);
+          outs.emplace_back();
+        }
+        ins[dst_proc]++;
+        outs[k].push_back(dst_proc);
+      }
+    }
+  }
+
+  // dependency order; procs start once all their upstream ones are done
+  std::unordered_map<uvw::Processor*, size_t> index;
+  for (size_t k = 0; k < reached.size(); k++)
+  {
+    index[reached[k]] = k;
+  }
+  push.seq.clear();
+  push.seq.push_back(root);
+  for (size_t k = 0; k < push.seq.size(); k++)
+  {
+    for (auto* dst_proc : outs[index[push.seq[k]]])
+    {
+      if (--ins[dst_proc] == 0)
+      {
+        push.seq.push_back(dst_proc);
+      }
+    }
+  }
+  if (push.seq.size() != reached.size())
+  {
+    std::cerr << "Cannot push " << key << " through cyclic links!" <<
+      std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool uvw::Workspace::set_input(const Duohash& key)
+{
+  if (has_var(key))
+  {
+    in_ = key;
+    return true;
+  }
+  return false;
+}
+
+bool uvw::Workspace::set_output(const Duohash& key)
+{
+  seq_.clear();
+  // re-plan pulls & re-fuse the new seq on the next process
+  pulls_.procs.clear();
+  fuse_stamp_.reset();
+  if (has_var(key))
+  {
+    out_ = key;
+    seq_ = uvw::Workspace::schedule(out_);
+    return (seq_.size() > 0);
+  }
+  return false;
+}
+
+bool uvw::Workspace::process(bool preprocess)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  // preprocessing runs disabled branches too, so they are ready once
+  // enabled again
+  return run_seq_(preprocess, update_prune_() && !preprocess);
+}
+
+bool uvw::Workspace::run_seq_(bool preprocess, bool pruning)
+{
+  if (!fused_)
+  {
+    return execute_(seq_, &pulls_, preprocess,
+      pruning? &prune_.skip : nullptr);
+  }
+
+  // re-fused on registry or link changes, e.g. a consumer linked to an
+  // intermediate of a fused run
+  if (!fuse_stamp_.valid() && !fuse())
+  {
+    return false;
+  }
+  // skipped procs per step; fused kernels are skipped if all of theirs are
+  if (pruning && (prune_.changed || prune_.steps.size() != steps_.size()))
+  {
+    prune_.steps.resize(steps_.size());
+    for (size_t k = 0; k < steps_.size(); k++)
+    {
+      auto& skip = prune_.steps[k];
+      skip.assign(steps_[k].procs.size() + 1, 1);
+      for (size_t i = 0; i < steps_[k].procs.size(); i++)
+      {
+        auto itr = prune_.index.find(steps_[k].procs[i]);
+        skip[i] = (itr != prune_.index.end() && prune_.skip[itr->second]);
+        skip.back() = skip.back() && skip[i];
+      }
+    }
+    prune_.changed = false;
+  }
+  for (size_t k = 0; k < steps_.size(); k++)
+  {
+    auto& step = steps_[k];
+    if (pruning && prune_.steps[k].back())
+    {
+      continue;
+    }
+    // kernels are equivalent to process only; preprocessing runs the
+    // procs of fused runs one by one
+    bool res = (step.kernels.size() && !preprocess)? run_(step) :
+      execute_(step.procs, &step.pulls, preprocess,
+        pruning? &prune_.steps[k] : nullptr);
+    if (!res)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool uvw::Workspace::update_prune_()
+{
+  if (prune_.seq != seq_ || !prune_.stamp.valid())
+  {
+    prune_all_();
+    return prune_.skipped > 0;
+  }
+  if (prune_.enabled_epoch == uvw::Variable::enabled_epoch_)
+  {
+    return prune_.skipped > 0;
+  }
+  prune_.enabled_epoch = uvw::Variable::enabled_epoch_;
+
+  // re-evaluate edges of toggled vars, then of procs flipped in turn
+  std::vector<size_t> flipped;
+  for (auto& itr : prune_.vars)
+  {
+    if (itr.first->enabled() != itr.second.first)
+    {
+      itr.second.first = itr.first->enabled();
+      for (auto e : itr.second.second)
+      {
+        prune_edge_(e, flipped);
+      }
+    }
+  }
+  while (flipped.size())
+  {
+    size_t i = flipped.back();
+    flipped.pop_back();
+    for (auto e : prune_.ins[i])
+    {
+      prune_edge_(e, flipped);
+    }
+  }
+  return prune_.skipped > 0;
+}
+
+void uvw::Workspace::prune_edge_(size_t e, std::vector<size_t>& flipped)
+{
+  auto& edge = prune_.edges[e];
+  bool active = edge.out->enabled() && edge.in->enabled() &&
+    (edge.dst == std::string::npos || !prune_.skip[edge.dst]);
+  if (active == edge.active)
+  {
+    return;
+  }
+  edge.active = active;
+  size_t& reasons = prune_.reasons[edge.src];
+  reasons = active? reasons + 1 : reasons - 1;
+  if ((reasons == 0) != (bool)prune_.skip[edge.src])
+  {
+    prune_.skip[edge.src] = !reasons;
+    if (reasons)
+    {
+      prune_.skipped--;
+    }
+    else
+    {
+      prune_.skipped++;
+    }
+    prune_.changed = true;
+    flipped.push_back(edge.src);
+  }
+}
+
+void uvw::Workspace::prune_all_()
+{
+  auto& p = prune_;
+  size_t n = seq_.size();
+  p.seq = seq_;
+  p.stamp.make(seq_);
+  p.enabled_epoch = uvw::Variable::enabled_epoch_;
+  p.edges.clear();
+  p.vars.clear();
+  p.index.clear();
+  p.outs.assign(1, 0);
+  p.ins.assign(n, std::vector<size_t>());
+  p.reasons.assign(n, 0);
+  p.skip.assign(n, 0);
+  p.skipped = 0;
+  p.changed = true;
+  for (size_t i = 0; i < n; i++)
+  {
+    p.index[seq_[i]] = i;
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    for (auto* v : seq_[i]->var_ptrs_)
+    {
+      for (const auto& key : v->incoming_)
+      {
+        uvw::Variable* in = get(key);
+        if (!in)
+        {
+          continue;
+        }
+        auto itr = p.index.find(in->proc());
+        size_t dst = (itr != p.index.end() && itr->second > i)?
+          itr->second : std::string::npos;
+        p.edges.push_back({i, dst, v, in, false});
+      }
+      // the output var is demanded as is
+      p.reasons[i] += (v->key() == out_);
+    }
+    p.outs.push_back(p.edges.size());
+  }
+  for (size_t e = 0; e < p.edges.size(); e++)
+  {
+    auto& edge = p.edges[e];
+    if (edge.dst != std::string::npos)
+    {
+      p.ins[edge.dst].push_back(e);
+    }
+    for (auto* v : {edge.out, edge.in})
+    {
+      auto& var = p.vars[v];
+      var.first = v->enabled();
+      var.second.push_back(e);
+    }
+  }
+
+  // procs fed later in the seq are settled first
+  for (size_t i = n; i-- > 0;)
+  {
+    if (p.outs[i] == p.outs[i + 1])
+    {
+      p.reasons[i]++;
+    }
+    for (size_t e = p.outs[i]; e < p.outs[i + 1]; e++)
+    {
+      auto& edge = p.edges[e];
+      edge.active = edge.out->enabled() && edge.in->enabled() &&
+        (edge.dst == std::string::npos || !p.skip[edge.dst]);
+      p.reasons[i] += edge.active;
+    }
+    p.skip[i] = !p.reasons[i];
+    p.skipped += p.skip[i];
+  }
+}
+
+// Builder impl.
+
+namespace
+{
+  // reserve room for n more entries; never shrinks, as rehashing tables
+  // left sparse by a clear is a pass over all their buckets
+  template<class C>
+  void grow_(C& c, size_t n)
+  {
+    if (c.bucket_count() * c.max_load_factor() < c.size() + n)
+    {
+      c.reserve(c.size() + n);
+    }
+  }
+};
+
+uvw::Builder::Builder(uvw::Workspace& ws, size_t n_procs, size_t n_links):
+  ws_(ws), n_procs_(n_procs)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  ws_.proc_ptrs_.reserve(ws_.proc_ptrs_.size() + n_procs);
+  grow_(uvw::Workspace::procs_, n_procs);
+  grow_(ws_.procs_set_, n_procs);
+  grow_(uvw::Workspace::vars_by_procs_, n_procs);
+  grow_(uvw::Workspace::links_, n_links);
+  links_.reserve(n_links);
+}
+
+void uvw::Builder::reserve_(size_t n_vars, const std::string& proc_type)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  grow_(uvw::Workspace::vars_, n_vars);
+  grow_(uvw::Workspace::procs_by_types_[proc_type], n_procs_);
+}
+
+uvw::Processor* uvw::Builder::add(const std::string& proc_type)
+{
+  bool first = (n_procs_ > 0);
+  uvw::Processor* proc_ptr = ws_.new_proc(proc_type);
+  if (proc_ptr && first)
+  {
+    // estimate var capacity & the type mix from the first proc
+    reserve_(n_procs_ * proc_ptr->var_keys().size(), proc_type);
+    n_procs_ = 0;
+  }
+  return proc_ptr;
+}
+
+void uvw::Builder::link(const uvw::Duohash& src, const uvw::Duohash& dst)
+{
+  links_.push_back({src, dst});
+}
+
+bool uvw::Builder::commit()
+{
+  std::vector<std::pair<uvw::Variable*, uvw::Variable*> > pairs;
+  pairs.reserve(links_.size());
+  for (const auto& lk : links_)
+  {
+    auto* src = uvw::Workspace::get(lk.first);
+    auto* dst = uvw::Workspace::get(lk.second);
+    if (!src || !dst || src->type_index() != dst->type_index())
+    {
+      std::cerr << "Cannot link between " << lk.first << " & " <<
+        lk.second << std::endl;
+      links_.clear();
+      return false;
+    }
+    pairs.push_back({src, dst});
+  }
+  links_.clear();
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+    // hook up keys & srcs, then resolve data sources once
+    std::vector<uvw::Variable*> dsts;
+    dsts.reserve(pairs.size());
+    for (auto& p : pairs)
+    {
+      auto* src = p.first;
+      auto* dst = p.second;
+      if (dst->src_var_)
+      {
+        dst->src_var_->incoming_.erase(dst->key_);
+        dst->src_var_->bump_();
+      }
+      dst->src_ = src->key_;
+      dst->src_var_ = src;
+      src->incoming_.insert(dst->key_);
+      src->bump_();
+      uvw::Workspace::links_[dst->key_] = dst->src_;
+      dsts.push_back(dst);
+    }
+    uvw::Variable::reroot_(dsts);
+
+    if (uvw::Variable::data_lazy)
+    {
+      for (auto& p : pairs)
+      {
+        p.second->touch();
+      }
+    }
+  }
+
+  bool res = true;
+  if (!in_.is_null())
+  {
+    res = ws_.set_input(in_) && res;
+    in_.nullify();
+  }
+  if (!out_.is_null())
+  {
+    res = ws_.set_output(out_) && res;
+    out_.nullify();
+  }
+  return res;
+}
+
+// Reload impl.
+
+uvw::Reload::Reload(uvw::Workspace& ws):
+  ws_(ws), busy_(false), ready_(false), released_(true)
+{
+}
+
+uvw::Reload::~Reload()
+{
+  ready_ = false;
+  if (!released_)
+  {
+    release_.set_value();
+  }
+  if (worker_.joinable())
+  {
+    worker_.join();
+  }
+}
+
+bool uvw::Reload::start(const json& data)
+{
+  if (busy_)
+  {
+    return false;
+  }
+  if (worker_.joinable())
+  {
+    worker_.join();
+  }
+  std::promise<bool> built;
+  built_ = built.get_future();
+  release_ = std::promise<void>();
+  released_ = false;
+  ready_ = false;
+  busy_ = true;
+  worker_ = std::thread(&uvw::Reload::run_, this, data,
+    std::move(built), release_.get_future());
+  return true;
+}
+
+bool uvw::Reload::start(const std::string& str)
+{
+  json data;
+  std::string err = picojson::parse(data, str);
+  if (!err.empty())
+  {
+    std::cerr << err << std::endl;
+    return false;
+  }
+  return start(data);
+}
+
+bool uvw::Reload::wait()
+{
+  if (built_.valid())
+  {
+    built_.wait();
+  }
+  return ready_;
+}
+
+bool uvw::Reload::swap()
+{
+  // the worker is done with next_ once ready; no locking needed
+  if (!ready_)
+  {
+    return false;
+  }
+  ws_.swap(next_);
+  ready_ = false;
+  released_ = true;
+  release_.set_value();
+  return true;
+}
+
+void uvw::Reload::run_(
+  json data,
+  std::promise<bool> built,
+  std::future<void> release
+)
+{
+  bool res = build_(data);
+  ready_ = res;
+  built.set_value(res);
+  if (res)
+  {
+    release.wait();
+  }
+  // the replaced procs after a swap, the new ones otherwise
+  next_.clear();
+  busy_ = false;
+}
+
+bool uvw::Reload::build_(json& data)
+{
+  if (!data.is<json::object>() || !next_.from_json(data))
+  {
+    return false;
+  }
+
+  bool fused, packed;
+  {
+    std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+    carry_over_();
+    fused = ws_.fused();
+    packed = ws_.packed();
+  }
+
+  // preprocess outside of the lock; the live workspace keeps processing
+  if (next_.seq_.size() && !uvw::Workspace::execute(next_.seq_, true))
+  {
+    std::cerr << "Cannot preprocess reloaded workspace!" << std::endl;
+    return false;
+  }
+  if (packed)
+  {
+    next_.pack();
+  }
+  if (fused)
+  {
+    next_.fuse();
+  }
+  return true;
+}
+
+void uvw::Reload::carry_over_()
+{
+  size_t n = std::min(ws_.proc_ptrs_.size(), next_.proc_ptrs_.size());
+  for (size_t i = 0; i < n; i++)
+  {
+    auto* proc_ptr = ws_.proc_ptrs_[i];
+    for (auto* v : next_.proc_ptrs_[i]->var_ptrs())
+    {
+      // vars of mismatched types keep their new values
+      auto* u = proc_ptr->get(v->label());
+      if (u)
+      {
+        v->copy_value(u);
+      }
+    }
+  }
+}
+
+// Parallel impl.
+
+uvw::Parallel::Parallel(
+  uvw::Workspace& ws,
+  size_t threads,
+  uvw::Parallel::Policy policy
+):
+  ws_(ws), policy_(policy),
+  fifos_(1), heaps_(1), ready_(0), skip_(nullptr),
+  remaining_(0), running_(0), failed_(false), preprocess_(false),
+  stopping_(false), decay(0.25)
+{
+  if (!threads)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  worker_parts_.assign(threads, 0);
+  for (size_t t = 1; t < threads; t++)
+  {
+    workers_.emplace_back(&uvw::Parallel::work_, this, t);
+  }
+}
+
+uvw::Parallel::~Parallel()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_)
+  {
+    worker.join();
+  }
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  unhome_();
+}
+
+bool uvw::Parallel::plan_()
+{
+  if (seq_ == ws_.seq_ && stamp_.valid())
+  {
+    return true;
+  }
+
+  // costs are kept for procs remaining in the seq
+  std::unordered_map<uvw::Processor*, size_t> index;
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    index[seq_[i]] = i;
+  }
+  std::vector<Node> nodes(ws_.seq_.size(), Node{{}, 0, 0, 0, false, 0});
+  for (size_t i = 0; i < ws_.seq_.size(); i++)
+  {
+    auto itr = index.find(ws_.seq_[i]);
+    if (itr != index.end())
+    {
+      nodes[i].cost = nodes_[itr->second].cost;
+      nodes[i].measured = nodes_[itr->second].measured;
+    }
+  }
+  seq_ = ws_.seq_;
+  nodes_.swap(nodes);
+  index.clear();
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    if (!uvw::Workspace::exists_(seq_[i]))
+    {
+      seq_.clear();
+      nodes_.clear();
+      return false;
+    }
+    index[seq_[i]] = i;
+  }
+
+  // edges from the procs pulled from; earlier in the seq only
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    std::vector<size_t> ins;
+    for (auto* v : seq_[i]->var_ptrs())
+    {
+      auto* src = uvw::Workspace::get(v->src());
+      auto itr = src? index.find(src->proc()) : index.end();
+      if (itr != index.end() && itr->second < i)
+      {
+        ins.push_back(itr->second);
+      }
+    }
+    std::sort(ins.begin(), ins.end());
+    ins.erase(std::unique(ins.begin(), ins.end()), ins.end());
+    for (auto j : ins)
+    {
+      nodes_[j].outs.push_back(i);
+    }
+    nodes_[i].ins = ins.size();
+  }
+
+  if (placed())
+  {
+    unhome_();
+    partition_();
+    home_();
+  }
+
+  // re-plan pulls on the next process
+  pulls_.procs.clear();
+  stamp_.make(seq_);
+  return true;
+}
+
+void uvw::Parallel::rank_()
+{
+  // procs not measured yet weigh the mean measured cost
+  double total = 0;
+  size_t measured = 0;
+  for (const auto& node : nodes_)
+  {
+    total += node.measured? node.cost : 0;
+    measured += node.measured;
+  }
+  double unit = measured? total / measured : 1;
+  for (size_t i = nodes_.size(); i-- > 0;)
+  {
+    auto& node = nodes_[i];
+    double rest = 0;
+    for (auto o : node.outs)
+    {
+      rest = std::max(rest, nodes_[o].rank);
+    }
+    node.rank = (node.measured? node.cost : unit) + rest;
+  }
+}
+
+double uvw::Parallel::critical_path() const
+{
+  std::vector<double> rest(nodes_.size(), 0);
+  double res = 0;
+  for (size_t i = nodes_.size(); i-- > 0;)
+  {
+    for (auto o : nodes_[i].outs)
+    {
+      rest[i] = std::max(rest[i], rest[o]);
+    }
+    rest[i] += nodes_[i].cost;
+    res = std::max(res, rest[i]);
+  }
+  return res;
+}
+
+void uvw::Parallel::push_(size_t i)
+{
+  ready_++;
+  size_t part = nodes_[i].part;
+  if (policy_ == FIFO)
+  {
+    fifos_[part].push_back(i);
+    return;
+  }
+  // highest rank first, then seq order
+  heaps_[part].push_back(i);
+  std::push_heap(heaps_[part].begin(), heaps_[part].end(),
+    [this](size_t a, size_t b)
+    {
+      return nodes_[a].rank < nodes_[b].rank ||
+        (nodes_[a].rank == nodes_[b].rank && a > b);
+    }
+  );
+}
+
+size_t uvw::Parallel::pop_(size_t part)
+{
+  // own partition first, then the others in turn
+  for (size_t k = 0; k < fifos_.size(); k++)
+  {
+    size_t p = (part + k) % fifos_.size();
+    size_t i;
+    if (fifos_[p].size())
+    {
+      i = fifos_[p].front();
+      fifos_[p].pop_front();
+    }
+    else if (heaps_[p].size())
+    {
+      std::pop_heap(heaps_[p].begin(), heaps_[p].end(),
+        [this](size_t a, size_t b)
+        {
+          return nodes_[a].rank < nodes_[b].rank ||
+            (nodes_[a].rank == nodes_[b].rank && a > b);
+        }
+      );
+      i = heaps_[p].back();
+      heaps_[p].pop_back();
+    }
+    else
+    {
+      continue;
+    }
+    ready_--;
+    return i;
+  }
+  return 0;
+}
+
+void uvw::Parallel::work_(size_t worker)
+{
+  using Clock = std::chrono::steady_clock;
+  bool caller = (worker == 0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    cv_.wait(lock, [this, caller]()
+      {
+        return stopping_ || (caller && done_()) || (!failed_ && ready_);
+      }
+    );
+    if (stopping_ || (caller && done_()))
+    {
+      return;
+    }
+    size_t i = pop_(worker_parts_[worker]);
+    running_++;
+    // pruned procs are done right away
+    bool skip = skip_ && (*skip_)[i];
+    lock.unlock();
+
+    // inputs are final; the procs pulled from are done
+    auto t0 = Clock::now();
+    bool res = skip || ((!uvw::Variable::data_pull ||
+        uvw::Workspace::pull_(pulls_, i)) &&
+      uvw::Workspace::process_(seq_[i], preprocess_, false));
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    lock.lock();
+    running_--;
+    remaining_--;
+    auto& node = nodes_[i];
+    if (!preprocess_ && !skip)
+    {
+      node.cost = node.measured? node.cost + decay * (secs - node.cost) : secs;
+      node.measured = true;
+    }
+    if (!res)
+    {
+      failed_ = true;
+    }
+    else
+    {
+      processed_[i] = !skip;
+      for (auto o : node.outs)
+      {
+        if (!--pending_[o])
+        {
+          push_(o);
+        }
+      }
+    }
+    cv_.notify_all();
+  }
+}
+
+bool uvw::Parallel::process(bool preprocess)
+{
+  std::lock_guard<std::recursive_mutex> ws_lock(uvw::Workspace::mutex_);
+  if (!plan_())
+  {
+    return false;
+  }
+  if (uvw::Variable::data_pull &&
+    (!pulls_.stamp.valid() ||
+      pulls_.procs.size() != seq_.size() + 1))
+  {
+    uvw::Workspace::plan_pulls_(seq_, pulls_);
+  }
+  // otherwise workers read inputs from their chain heads as resolved by
+  // the last link change under the lock held here (see
+  // Variable::reroot_), without writing to the vars read
+  if (policy_ == CRITICAL_PATH)
+  {
+    rank_();
+  }
+  // see Workspace::process on pruning
+  bool pruning = ws_.update_prune_() && !preprocess;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    skip_ = pruning? &ws_.prune_.skip : nullptr;
+    for (size_t p = 0; p < fifos_.size(); p++)
+    {
+      fifos_[p].clear();
+      heaps_[p].clear();
+    }
+    ready_ = 0;
+    pending_.resize(nodes_.size());
+    processed_.assign(nodes_.size(), 0);
+    remaining_ = nodes_.size();
+    running_ = 0;
+    failed_ = false;
+    preprocess_ = preprocess;
+    for (size_t i = 0; i < nodes_.size(); i++)
+    {
+      pending_[i] = nodes_[i].ins;
+      if (!pending_[i])
+      {
+        push_(i);
+      }
+    }
+  }
+  cv_.notify_all();
+
+#ifdef __linux__
+  // the caller works on the first cpu while processing
+  cpu_set_t caller_cpus;
+  bool pinned = placed() &&
+    !pthread_getaffinity_np(pthread_self(), sizeof(caller_cpus),
+      &caller_cpus) &&
+    pin_(pthread_self(), {cpus_[0]});
+#endif
+  work_(0);
+#ifdef __linux__
+  if (pinned)
+  {
+    pthread_setaffinity_np(pthread_self(), sizeof(caller_cpus), &caller_cpus);
+  }
+#endif
+
+  // subscriptions fire on the caller once the frame is joined, in seq
+  // order, so callbacks may take the workspace lock held by the caller
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    if (processed_[i] && seq_[i]->watched_)
+    {
+      uvw::Workspace::notify_(seq_[i]);
+    }
+  }
+  return !failed_;
+}
+
+int uvw::Parallel::cpu_node(int cpu)
+{
+#ifdef __linux__
+  std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+  DIR* dir = opendir(path.c_str());
+  if (!dir)
+  {
+    return 0;
+  }
+  int node = 0;
+  while (auto* entry = readdir(dir))
+  {
+    std::string name = entry->d_name;
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+      std::isdigit(name[4]))
+    {
+      node = std::atoi(name.c_str() + 4);
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+#else
+  return 0;
+#endif
+}
+
+bool uvw::Parallel::pin_(
+  std::thread::native_handle_type thread,
+  const std::vector<int>& cpus
+)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus)
+  {
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool uvw::Parallel::place(
+  const std::vector<int>& cpus,
+  const std::vector<int>& nodes
+)
+{
+  std::lock_guard<std::recursive_mutex> ws_lock(uvw::Workspace::mutex_);
+  unplace();
+
+#ifdef __linux__
+  cpu_set_t usable;
+  CPU_ZERO(&usable);
+  sched_getaffinity(0, sizeof(usable), &usable);
+#endif
+  std::vector<int> cpu_nodes;
+  for (size_t k = 0; k < cpus.size(); k++)
+  {
+    int cpu = cpus[k];
+#ifdef __linux__
+    bool valid = (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &usable));
+#else
+    bool valid = (cpu >= 0);
+#endif
+    if (!valid)
+    {
+      std::cerr << "Warning: cpu " << cpu << " is not available!" <<
+        std::endl;
+      continue;
+    }
+    cpus_.push_back(cpu);
+    cpu_nodes.push_back(k < nodes.size()? nodes[k] : cpu_node(cpu));
+  }
+  if (cpus_.empty())
+  {
+    std::cerr << "Failure: no cpu to place workers on!" << std::endl;
+    return false;
+  }
+  cpu_nodes_ = cpu_nodes;
+  std::sort(cpu_nodes.begin(), cpu_nodes.end());
+  cpu_nodes.erase(std::unique(cpu_nodes.begin(), cpu_nodes.end()),
+    cpu_nodes.end());
+  part_nodes_ = cpu_nodes;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fifos_.assign(parts(), std::deque<size_t>());
+    heaps_.assign(parts(), std::vector<size_t>());
+    for (size_t w = 0; w < worker_parts_.size(); w++)
+    {
+      int node = cpu_nodes_[w % cpus_.size()];
+      worker_parts_[w] = std::lower_bound(part_nodes_.begin(),
+        part_nodes_.end(), node) - part_nodes_.begin();
+    }
+  }
+  for (size_t t = 0; t < workers_.size(); t++)
+  {
+    if (!pin_(workers_[t].native_handle(), {cpus_[(t + 1) % cpus_.size()]}))
+    {
+      std::cerr << "Warning: cannot pin worker " << t + 1 << "!" << std::endl;
+    }
+  }
+
+  // re-plan the partitions & storage
+  stamp_.reset();
+  return plan_();
+}
+
+void uvw::Parallel::unplace()
+{
+  std::lock_guard<std::recursive_mutex> ws_lock(uvw::Workspace::mutex_);
+  if (!placed())
+  {
+    return;
+  }
+  unhome_();
+#ifdef __linux__
+  cpu_set_t usable;
+  CPU_ZERO(&usable);
+  sched_getaffinity(0, sizeof(usable), &usable);
+  for (auto& worker : workers_)
+  {
+    pthread_setaffinity_np(worker.native_handle(), sizeof(usable), &usable);
+  }
+#endif
+  cpus_.clear();
+  cpu_nodes_.clear();
+  part_nodes_.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  fifos_.assign(1, std::deque<size_t>());
+  heaps_.assign(1, std::vector<size_t>());
+  worker_parts_.assign(worker_parts_.size(), 0);
+  for (auto& node : nodes_)
+  {
+    node.part = 0;
+  }
+}
+
+void uvw::Parallel::partition_()
+{
+  // contiguous seq ranges, sized by costs in proportion to cpus per node
+  std::vector<double> shares(parts(), 0);
+  for (int node : cpu_nodes_)
+  {
+    shares[std::lower_bound(part_nodes_.begin(), part_nodes_.end(), node) -
+      part_nodes_.begin()] += 1.0 / cpu_nodes_.size();
+  }
+  double total = 0;
+  size_t measured = 0;
+  for (const auto& node : nodes_)
+  {
+    total += node.measured? node.cost : 0;
+    measured += node.measured;
+  }
+  double unit = measured? total / measured : 1;
+  total = 0;
+  for (const auto& node : nodes_)
+  {
+    total += node.measured? node.cost : unit;
+  }
+
+  size_t part = 0;
+  double sum = 0, bound = shares[0] * total;
+  for (auto& node : nodes_)
+  {
+    double cost = node.measured? node.cost : unit;
+    while (part + 1 < shares.size() && sum + cost / 2 > bound)
+    {
+      bound += shares[++part] * total;
+    }
+    node.part = part;
+    sum += cost;
+  }
+}
+
+void uvw::Parallel::home_()
+{
+  // nothing to gain on a single node; packed vars stay in their slabs
+  if (parts() < 2 || ws_.packed())
+  {
+    return;
+  }
+  homes_.resize(parts());
+  for (size_t p = 0; p < parts(); p++)
+  {
+    // per type runs of cache-line aligned storage
+    std::map<std::type_index, std::vector<Variable*> > runs;
+    for (size_t i = 0; i < seq_.size(); i++)
+    {
+      if (nodes_[i].part != p)
+      {
+        continue;
+      }
+      for (auto* v : seq_[i]->var_ptrs())
+      {
+        if (v->is_trivial() && !v->data_seq_)
+        {
+          runs[v->type_index()].push_back(v);
+        }
+      }
+    }
+    std::vector<std::pair<Variable*, size_t> > offsets;
+    size_t size = 0;
+    for (const auto& run : runs)
+    {
+      size = (size + 63) / 64 * 64;
+      for (auto* v : run.second)
+      {
+        offsets.push_back({v, size});
+        size += v->data_size();
+      }
+    }
+    if (offsets.empty())
+    {
+      continue;
+    }
+
+    // allocated & zeroed by a thread on the node, which first touches it;
+    // vars are moved in on this thread, which holds the registry lock
+    std::vector<int> node_cpus;
+    for (size_t k = 0; k < cpus_.size(); k++)
+    {
+      if (cpu_nodes_[k] == part_nodes_[p])
+      {
+        node_cpus.push_back(cpus_[k]);
+      }
+    }
+    auto& home = homes_[p];
+    std::thread toucher([&]()
+      {
+#ifdef __linux__
+        pin_(pthread_self(), node_cpus);
+#endif
+        home.assign(size + 63, 0);
+      }
+    );
+    toucher.join();
+    char* base = home.data() + (64 - (size_t)home.data() % 64) % 64;
+    for (const auto& itr : offsets)
+    {
+      itr.first->rebind(base + itr.second);
+      homed_.push_back({itr.first->key(), itr.first});
+    }
+  }
+}
+
+void uvw::Parallel::unhome_()
+{
+  for (const auto& itr : homed_)
+  {
+    // vars of removed procs are gone; others may have been moved since
+    Variable* v = itr.second;
+    if (uvw::Workspace::get(itr.first) != v)
+    {
+      continue;
+    }
+    char* data = (char*)v->raw_data();
+    for (const auto& home : homes_)
+    {
+      if (data >= home.data() && data < home.data() + home.size())
+      {
+        v->rebind(nullptr);
+        break;
+      }
+    }
+  }
+  homed_.clear();
+  homes_.clear();
+}
+
+std::vector<std::pair<uvw::Duohash, uvw::Duohash> >
+  uvw::Parallel::remote_links() const
+{
+  std::vector<std::pair<Duohash, Duohash> > res;
+  std::unordered_map<uvw::Processor*, size_t> index;
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    index[seq_[i]] = i;
+  }
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    for (auto* v : seq_[i]->var_ptrs())
+    {
+      auto* src = uvw::Workspace::get(v->src());
+      auto itr = src? index.find(src->proc()) : index.end();
+      if (itr != index.end() && nodes_[itr->second].part != nodes_[i].part)
+      {
+        res.push_back({v->src(), v->key()});
+      }
+    }
+  }
+  return res;
+}
+
+// kernel fusion
+
+namespace
+{
+  bool is_kernel_var_(uvw::Variable* v)
+  {
+    return v && (v->is_of_type<double>() ||
+      v->is_of_type<std::vector<double> >());
+  }
+};
+
+bool uvw::Workspace::fuse()
+{
+  steps_.clear();
+  fused_ = false;
+  if (!seq_.size())
+  {
+    return false;
+  }
+
+  // kernels of fusible procs
+  std::vector<uvw::Kernel> kernels(seq_.size());
+  std::vector<bool> fusible(seq_.size(), false);
+  for (size_t i = 0; i < seq_.size(); i++)
+  {
+    auto& k = kernels[i];
+    bool res = seq_[i]->kernel(k) && k.eval && k.outs.size();
+    for (auto* v : k.ins)
+    {
+      res = res && is_kernel_var_(v);
+    }
+    for (auto* v : k.outs)
+    {
+      res = res && is_kernel_var_(v);
+    }
+    fusible[i] = res;
+  }
+
+  size_t i = 0;
+  while (i < seq_.size())
+  {
+    size_t j = i + 1;
+    while (j < seq_.size() && fusible[j] == fusible[i])
+    {
+      j++;
+    }
+
+    if (!fusible[i] || j - i < 2)
+    {
+      // plain runs & single fusible procs are processed as usual
+      if (!steps_.size() || steps_.back().kernels.size())
+      {
+        steps_.push_back(Step());
+      }
+      steps_.back().procs.insert(steps_.back().procs.end(),
+        seq_.begin() + i, seq_.begin() + j);
+      i = j;
+      continue;
+    }
+
+    Step step;
+    std::unordered_set<uvw::Duohash> kernel_ins;
+    for (size_t k = i; k < j; k++)
+    {
+      step.procs.push_back(seq_[k]);
+      step.kernels.push_back(kernels[k]);
+      for (auto* v : kernels[k].ins)
+      {
+        kernel_ins.insert(v->key());
+      }
+    }
+
+    // outputs only read by kernel inputs of the run become tiles
+    std::unordered_map<uvw::Variable*, size_t> out_args;
+    for (auto& k : step.kernels)
+    {
+      std::vector<size_t> ins, outs;
+      for (auto* v : k.ins)
+      {
+        auto* src = v->src().is_null()? nullptr : get(v->src());
+        if (src && out_args.find(src) != out_args.end())
+        {
+          ins.push_back(out_args[src]);
+          continue;
+        }
+        ins.push_back(step.args.size());
+        step.args.push_back(
+          {v, v->is_of_type<std::vector<double> >(), true});
+      }
+      for (auto* v : k.outs)
+      {
+        bool internal = v->incoming_.size() &&
+          !(v->key() == in_) && !(v->key() == out_);
+        for (const auto& dst : v->incoming_)
+        {
+          internal = internal && kernel_ins.count(dst);
+        }
+        out_args[v] = step.args.size();
+        outs.push_back(step.args.size());
+        step.args.push_back(
+          {internal? nullptr : v, v->is_of_type<std::vector<double> >(),
+            false});
+      }
+      step.ins.push_back(ins);
+      step.outs.push_back(outs);
+    }
+    step.tiles.resize(step.args.size() * tile_size);
+    step.ptrs.resize(step.args.size());
+    step.advance.resize(step.args.size());
+    for (auto& k : step.kernels)
+    {
+      step.in_ptrs.resize(std::max(step.in_ptrs.size(), k.ins.size()));
+      step.out_ptrs.resize(std::max(step.out_ptrs.size(), k.outs.size()));
+    }
+    steps_.push_back(step);
+    i = j;
+  }
+
+  fused_ = true;
+  fuse_stamp_.make(seq_);
+  return true;
+}
+
+void uvw::Workspace::unfuse()
+{
+  steps_.clear();
+  fused_ = false;
+  fuse_stamp_.reset();
+}
+
+bool uvw::Workspace::run_(Step& step)
+{
+  for (auto* proc_ptr : step.procs)
+  {
+    if (!exists_(proc_ptr))
+    {
+      return false;
+    }
+  }
+
+  // batch size of external inputs; scalars are broadcast
+  size_t n = 1;
+  bool batch = false;
+  for (auto& arg : step.args)
+  {
+    if (arg.input && arg.batch)
+    {
+      auto* data = arg.var->src_data_()?
+        arg.var->data_src_ : arg.var->data_ptr_;
+      size_t size = ((std::vector<double>*)data)->size();
+      if (batch && size != n)
+      {
+        std::cerr << "Mismatched batch size of " << arg.var->key() <<
+          "!" << std::endl;
+        return false;
+      }
+      n = size;
+      batch = true;
+    }
+  }
+  // then outputs, wherever listed
+  for (auto& arg : step.args)
+  {
+    if (!arg.input && arg.var && !arg.batch && batch)
+    {
+      std::cerr << "Cannot write batch to scalar " << arg.var->key() <<
+        "!" << std::endl;
+      return false;
+    }
+  }
+  for (auto& arg : step.args)
+  {
+    if (!arg.input && arg.var && arg.batch)
+    {
+      ((std::vector<double>*)arg.var->data_ptr_)->resize(n);
+    }
+  }
+
+  // base ptrs; batch args advance with each tile
+  for (size_t a = 0; a < step.args.size(); a++)
+  {
+    auto& arg = step.args[a];
+    double* tile = step.tiles.data() + a * tile_size;
+    step.advance[a] = false;
+    if (!arg.var)
+    {
+      step.ptrs[a] = tile;
+      continue;
+    }
+    auto* data = (arg.input && arg.var->src_data_())?
+      arg.var->data_src_ : arg.var->data_ptr_;
+    if (arg.batch)
+    {
+      step.ptrs[a] = ((std::vector<double>*)data)->data();
+      step.advance[a] = true;
+    }
+    else if (batch)
+    {
+      std::fill(tile, tile + tile_size, *((double*)data));
+      step.ptrs[a] = tile;
+    }
+    else
+    {
+      step.ptrs[a] = (double*)data;
+    }
+  }
+
+  for (size_t t = 0; t < n; t += tile_size)
+  {
+    size_t m = std::min(tile_size, n - t);
+    for (size_t k = 0; k < step.kernels.size(); k++)
+    {
+      auto& ins = step.ins[k];
+      auto& outs = step.outs[k];
+      for (size_t j = 0; j < ins.size(); j++)
+      {
+        step.in_ptrs[j] = step.ptrs[ins[j]] + (step.advance[ins[j]]? t : 0);
+      }
+      for (size_t j = 0; j < outs.size(); j++)
+      {
+        step.out_ptrs[j] =
+          step.ptrs[outs[j]] + (step.advance[outs[j]]? t : 0);
+      }
+      step.kernels[k].eval(step.in_ptrs.data(), step.out_ptrs.data(), m);
+    }
+  }
+
+  for (auto* proc_ptr : step.procs)
+  {
+    proc_ptr->stale_ = false;
+    if (proc_ptr->watched_)
+    {
+      notify_(proc_ptr);
+    }
+  }
+  return true;
+}
+
+// json
+
+bool uvw::Workspace::from_str(const std::string& str)
+{
+  json data;
+  std::string err = picojson::parse(data, str);
+  if (!err.empty())
+  {
+    std::cerr << err << std::endl;
+    return false;
+  }
+  return from_json(data);
+}
+
+json uvw::Workspace::to_json()
+{
+  if (!proc_ptrs_.size())
+  {
+    return json();
+  }
+
+  json::object data_obj;
+  std::unordered_map<void*, int64_t> indices_by_procs;
+  json::array proc_list;
+  for (auto* proc_ptr : proc_ptrs_)
+  {
+    int64_t index = indices_by_procs.size();
+    indices_by_procs[proc_ptr] = index;
+
+    auto proc_obj = proc_ptr->to_json().get<json::object>();
+    proc_obj["index"] = json(index);
+    proc_list.push_back(json(proc_obj));
+  }
+  data_obj["procs"] = json(proc_list);
+
+  auto is_indexed_ = [&indices_by_procs](void* ptr)
+  {
+    return (indices_by_procs.find(ptr) != indices_by_procs.end());
+  };
+
+  json::array link_list;
+  for (const auto& itr : links_)
+  {
+    if (is_indexed_(itr.first.raw_ptr) || is_indexed_(itr.second.raw_ptr))
+    {
+      json::object var_obj;
+      json::object src_obj;
+      var_obj["index"] = json(indices_by_procs[itr.first.raw_ptr]);
+      var_obj["label"] = json(itr.first.var_str);
+      src_obj["index"] = json(indices_by_procs[itr.second.raw_ptr]);
+      src_obj["label"] = json(itr.second.var_str);
+      json::object link_obj;
+      link_obj["var"] = json(var_obj);
+      link_obj["src"] = json(src_obj);
+      link_list.push_back(json(link_obj));
+    }
+    else
+    {
+      // neither is in the ws scope...
+    }
+  }
+  data_obj["links"] = json(link_list);
+
+  if (has_var(in_) && is_indexed_(in_.raw_ptr))
+  {
+    json::object in_obj;
+    in_obj["index"] = json(indices_by_procs[in_.raw_ptr]);
+    in_obj["label"] = json(in_.var_str);
+    data_obj["in"] = json(in_obj);
+  }
+  if (has_var(out_) && is_indexed_(out_.raw_ptr))
+  {
+    json::object out_obj;
+    out_obj["index"] = json(indices_by_procs[out_.raw_ptr]);
+    out_obj["label"] = json(out_.var_str);
+    data_obj["out"] = json(out_obj);
+  }
+  return json(data_obj);
+}
+
+bool uvw::Workspace::from_json(json& data)
+{
+  auto& data_obj = data.get<json::object>();
+  std::unordered_map<int64_t, void*> procs_by_indices;
+
+  bool has_procs = (data_obj.find("procs") != data_obj.end() &&
+    data_obj["procs"].is<json::array>());
+  bool has_links = (data_obj.find("links") != data_obj.end() &&
+    data_obj["links"].is<json::array>());
+  uvw::Builder builder(*this,
+    has_procs? data_obj["procs"].get<json::array>().size() : 0,
+    has_links? data_obj["links"].get<json::array>().size() : 0
+  );
+
+  if (has_procs)
+  {
+    for (auto& data_itr : data_obj["procs"].get<json::array>())
+    {
+      auto& proc_obj = data_itr.get<json::object>();
+      auto proc_type = proc_obj["type"].get<std::string>();
+      auto* proc_ptr = builder.add(proc_type);
+      if (!proc_ptr)
+      {
+        std::cerr << "Cannot create proc type '" <<
+          proc_type << "'!" << std::endl;
+        return false;
+      }
+
+      procs_by_indices[procs_by_indices.size()] = proc_ptr;
+      if (!proc_ptr->from_json(data_itr))
+      {
+        return false;
+      }
+    }
+  }
+
+  auto has_index_ = [&procs_by_indices](int64_t index)
+  {
+    return (procs_by_indices.find(index) !=
+      procs_by_indices.end());
+  };
+
+  // intra-links amongst ws procs/vars, made at once on commit
+  if (has_links)
+  {
+    for (auto& data_itr : data_obj["links"].get<json::array>())
+    {
+      auto& link_obj = data_itr.get<json::object>();
+      auto& var_obj = link_obj["var"].get<json::object>();
+      auto& src_obj = link_obj["src"].get<json::object>();
+      auto var_index = var_obj["index"].get<int64_t>();
+      auto src_index = src_obj["index"].get<int64_t>();
+      if (!has_index_(var_index) || !has_index_(src_index))
+      {
+        std::cout << "Cannot find proc index " << var_index <<
+          " or " << src_index << "! Skipping..." << std::endl;
+        continue;
+      }
+      auto* p = procs_by_indices[var_index];
+      auto* q = procs_by_indices[src_index];
+      uvw::Duohash dst(p, var_obj["label"].get<std::string>());
+      uvw::Duohash src(q, src_obj["label"].get<std::string>());
+      builder.link(src, dst);
+    }
+  }
+  if (!builder.commit())
+  {
+    return false;
+  }
+
+  if (data_obj.find("in") != data_obj.end())
+  {
+    auto& in_obj = data_obj["in"].get<json::object>();
+    auto in_index = in_obj["index"].get<int64_t>();
+    if (has_index_(in_index))
+    {
+      auto* p = procs_by_indices[in_index];
+      auto k_in = uvw::Duohash(p, in_obj["label"].get<std::string>());
+      if (!set_input(k_in))
+      {
+        std::cerr << "Cannot set input " << k_in << "!" << std::endl;
+      }
+    }
+    else
+    {
+      std::cerr << "Cannot find in index " << in_index << "!" << std::endl;
+    }
+  }
+  if (data_obj.find("out") != data_obj.end())
+  {
+    auto& out_obj = data_obj["out"].get<json::object>();
+    auto out_index = out_obj["index"].get<int64_t>();
+    if (has_index_(out_index))
+    {
+      auto* q = procs_by_indices[out_index];
+      auto k_out = uvw::Duohash(q, out_obj["label"].get<std::string>());
+      if (!set_output(k_out))
+      {
+        std::cerr << "Cannot set output " << k_out << "!" << std::endl;
+      }
+    }
+    else
+    {
+      std::cerr << "Cannot find out index " << out_index << "!" << std::endl;
+    }
+  }
+  return true;
+}
+
+bool uvw::Workspace::pack()
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  unpack();
+
+  // vars of scheduled procs first, in processing order
+  std::vector<uvw::Processor*> proc_order(seq_);
+  std::unordered_set<uvw::Processor*> ordered(seq_.begin(), seq_.end());
+  for (auto* proc_ptr : proc_ptrs_)
+  {
+    if (ordered.insert(proc_ptr).second)
+    {
+      proc_order.push_back(proc_ptr);
+    }
+  }
+
+  // shared or non-trivial vars keep their storage
+  std::map<std::type_index, size_t> slab_sizes;
+  for (auto* proc_ptr : proc_order)
+  {
+    for (auto* v : proc_ptr->var_ptrs_)
+    {
+      if (v->is_trivial() && !v->data_seq_)
+      {
+        slab_sizes[v->type_index()] += v->data_size();
+        packed_vars_.push_back(v);
+      }
+    }
+  }
+  if (packed_vars_.empty())
+  {
+    return false;
+  }
+
+  std::map<std::type_index, size_t> slab_indices;
+  slabs_.reserve(slab_sizes.size());
+  for (const auto& itr : slab_sizes)
+  {
+    slab_indices[itr.first] = slabs_.size();
+    slabs_.push_back({itr.first, std::vector<char>(itr.second + 63), nullptr, 0});
+    // cache-line aligned start
+    auto& slab = slabs_.back();
+    size_t addr = (size_t)slab.buf.data();
+    slab.data = slab.buf.data() + ((64 - addr % 64) % 64);
+  }
+
+  for (auto* v : packed_vars_)
+  {
+    auto& slab = slabs_[slab_indices[v->type_index()]];
+    v->rebind(slab.data + slab.size);
+    slab.size += v->data_size();
+  }
+  return true;
+}
+
+bool uvw::Workspace::unpack()
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (slabs_.empty())
+  {
+    return false;
+  }
+  for (auto* v : packed_vars_)
+  {
+    v->rebind(nullptr);
+  }
+  packed_vars_.clear();
+  slabs_.clear();
+  return true;
+}
+
+namespace
+{
+  // per-size copies of scattered values to & from a contiguous block,
+  // so each value is a single move
+  template<size_t N>
+  void gather_raw_(char* dst, char* const* srcs, size_t n)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      std::memcpy(dst + i * N, srcs[i], N);
+    }
+  }
+
+  template<size_t N>
+  void scatter_raw_(char* const* dsts, const char* src, size_t n)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      std::memcpy(dsts[i], src + i * N, N);
+    }
+  }
+
+  bool gatherable_(size_t size)
+  {
+    return size == 1 || size == 2 || size == 4 || size == 8 || size == 16;
+  }
+
+  void gather_raw_(char* dst, char* const* srcs, size_t n, size_t size)
+  {
+    switch (size)
+    {
+      case 1: gather_raw_<1>(dst, srcs, n); break;
+      case 2: gather_raw_<2>(dst, srcs, n); break;
+      case 4: gather_raw_<4>(dst, srcs, n); break;
+      case 8: gather_raw_<8>(dst, srcs, n); break;
+      case 16: gather_raw_<16>(dst, srcs, n); break;
+    }
+  }
+
+  void scatter_raw_(char* const* dsts, const char* src, size_t n,
+    size_t size)
+  {
+    switch (size)
+    {
+      case 1: scatter_raw_<1>(dsts, src, n); break;
+      case 2: scatter_raw_<2>(dsts, src, n); break;
+      case 4: scatter_raw_<4>(dsts, src, n); break;
+      case 8: scatter_raw_<8>(dsts, src, n); break;
+      case 16: scatter_raw_<16>(dsts, src, n); break;
+    }
+  }
+};
+
+bool uvw::Workspace::layout_state_()
+{
+  if (state_version_ == *version_)
+  {
+    return true;
+  }
+  state_runs_.clear();
+  state_gathers_.clear();
+  state_codecs_.clear();
+  state_size_ = 0;
+
+  // packed slabs are copied whole
+  for (const auto& slab : slabs_)
+  {
+    state_runs_.push_back({slab.data, state_size_, slab.size});
+    state_size_ += slab.size;
+  }
+  auto in_slabs_ = [this](char* ptr)
+  {
+    for (const auto& slab : slabs_)
+    {
+      if (ptr >= slab.data && ptr < slab.data + slab.size)
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  std::vector<StateRun> runs;
+  for (auto* proc_ptr : proc_ptrs_)
+  {
+    for (auto* v : proc_ptr->var_ptrs_)
+    {
+      char* ptr = (char*)v->data_ptr_;
+      if (!ptr || in_slabs_(ptr))
+      {
+        continue;
+      }
+      if (!v->is_trivial())
+      {
+        auto itr = uvw::Variable::state_codecs.find(v->type_index());
+        if (itr == uvw::Variable::state_codecs.end())
+        {
+          std::cout << "Warning: no state codec for var " <<
+            v->key() << "; skipped." << std::endl;
+          continue;
+        }
+        state_codecs_.push_back({v, &itr->second});
+        continue;
+      }
+
+      // merge values adjacent in memory into a single copy
+      size_t size = v->data_size();
+      if (runs.size() && runs.back().ptr + runs.back().size == ptr)
+      {
+        runs.back().size += size;
+      }
+      else
+      {
+        runs.push_back({ptr, 0, size});
+      }
+    }
+  }
+
+  // small runs are gathered per size, the others follow
+  std::map<size_t, std::vector<char*> > gathers;
+  for (const auto& run : runs)
+  {
+    if (gatherable_(run.size))
+    {
+      gathers[run.size].push_back(run.ptr);
+    }
+  }
+  for (auto& itr : gathers)
+  {
+    state_gathers_.push_back({itr.first, state_size_, std::move(itr.second)});
+    state_size_ += itr.first * state_gathers_.back().ptrs.size();
+  }
+  for (const auto& run : runs)
+  {
+    if (!gatherable_(run.size))
+    {
+      state_runs_.push_back({run.ptr, state_size_, run.size});
+      state_size_ += run.size;
+    }
+  }
+  state_version_ = *version_;
+  return true;
+}
+
+bool uvw::Workspace::save_state(std::vector<char>& buf)
+{
+  if (!layout_state_())
+  {
+    return false;
+  }
+
+  // header: raw state size & codec var count
+  uint64_t header[2] = {state_size_, state_codecs_.size()};
+  buf.resize(sizeof(header) + state_size_);
+  std::memcpy(buf.data(), header, sizeof(header));
+
+  char* data = buf.data() + sizeof(header);
+  for (const auto& gather : state_gathers_)
+  {
+    gather_raw_(data + gather.offset, gather.ptrs.data(), gather.ptrs.size(),
+      gather.size);
+  }
+  for (const auto& run : state_runs_)
+  {
+    std::memcpy(data + run.offset, run.ptr, run.size);
+  }
+  for (const auto& itr : state_codecs_)
+  {
+    itr.second->save(itr.first->data_ptr_, buf);
+  }
+  return true;
+}
+
+bool uvw::Workspace::load_state(const std::vector<char>& buf)
+{
+  if (!layout_state_())
+  {
+    return false;
+  }
+
+  uint64_t header[2];
+  if (buf.size() < sizeof(header) + state_size_)
+  {
+    std::cerr << "State size mismatch!" << std::endl;
+    return false;
+  }
+  std::memcpy(header, buf.data(), sizeof(header));
+  if (header[0] != state_size_ || header[1] != state_codecs_.size())
+  {
+    std::cerr << "State layout mismatch!" << std::endl;
+    return false;
+  }
+
+  const char* data = buf.data() + sizeof(header);
+  for (const auto& gather : state_gathers_)
+  {
+    scatter_raw_(gather.ptrs.data(), data + gather.offset,
+      gather.ptrs.size(), gather.size);
+  }
+  for (const auto& run : state_runs_)
+  {
+    std::memcpy(run.ptr, data + run.offset, run.size);
+  }
+  size_t pos = sizeof(header) + state_size_;
+  for (const auto& itr : state_codecs_)
+  {
+    size_t len = itr.second->load(
+      itr.first->data_ptr_, buf.data() + pos, buf.size() - pos
+    );
+    if (!len)
+    {
+      std::cerr << "Cannot load state of var " <<
+        itr.first->key() << "!" << std::endl;
+      return false;
+    }
+    pos += len;
+  }
+
+  for (auto* proc_ptr : proc_ptrs_)
+  {
+    proc_ptr->stale_ = true;
+  }
+  return true;
+}
+
+namespace
+{
+  // delta fields by their flags; see Variable::mark_delta
+  const std::vector<std::pair<uint8_t, std::string> > delta_fields_ = {
+    {uvw::Variable::DELTA_VALUE, "value"},
+    {uvw::Variable::DELTA_ENABLED, "enabled"},
+    {uvw::Variable::DELTA_ENUMS, "enums"}
+  };
+  const uint8_t delta_all_ = uvw::Variable::DELTA_VALUE |
+    uvw::Variable::DELTA_ENABLED | uvw::Variable::DELTA_ENUMS;
+
+  // the flagged delta fields of a var; removed enums as an empty list
+  json::object delta_obj_(uvw::Variable* v, uint8_t fields)
+  {
+    json data = v->to_json();
+    auto& data_obj = data.get<json::object>();
+    if (data_obj.find("enums") == data_obj.end())
+    {
+      data_obj["enums"] = json(json::array());
+    }
+    json::object var_obj;
+    for (const auto& field : delta_fields_)
+    {
+      if ((fields & field.first) &&
+            data_obj.find(field.second) != data_obj.end())
+      {
+        var_obj[field.second] = data_obj[field.second];
+      }
+    }
+    return var_obj;
+  }
+};
+
+json uvw::Workspace::to_delta()
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (held_.size())
+  {
+    settle_();
+  }
+  if (delta_version_ != *version_)
+  {
+    delta_index_.clear();
+    for (size_t index = 0; index < proc_ptrs_.size(); index++)
+    {
+      delta_index_[proc_ptrs_[index]] = index;
+    }
+    delta_version_ = *version_;
+  }
+
+  // take the flagged vars of this ws off the list, by proc index
+  std::vector<std::pair<size_t, uvw::Variable*> > flagged;
+  size_t kept = 0;
+  for (const auto& key : deltas_)
+  {
+    // keys of erased vars are either gone or reused by vars not listed;
+    // vars listed twice are seen once
+    auto itr = vars_.find(key);
+    if (itr == vars_.end() ||
+          !(itr->second->delta_ & Variable::delta_listed_))
+    {
+      continue;
+    }
+    uvw::Variable* v = itr->second;
+    v->delta_ &= ~Variable::delta_listed_;
+    auto index_itr = delta_index_.find(v->proc());
+    if (index_itr != delta_index_.end())
+    {
+      flagged.push_back({index_itr->second, v});
+    }
+    else if (v->delta_)
+    {
+      deltas_[kept++] = key;
+    }
+  }
+  deltas_.resize(kept);
+  for (const auto& key : deltas_)
+  {
+    vars_[key]->delta_ |= Variable::delta_listed_;
+  }
+  std::stable_sort(flagged.begin(), flagged.end(),
+    [](const std::pair<size_t, uvw::Variable*>& lhs,
+      const std::pair<size_t, uvw::Variable*>& rhs)
+    {
+      return lhs.first < rhs.first;
+    });
+
+  json::array var_list;
+  auto emit = [&var_list](size_t index, uvw::Variable* v, uint8_t fields)
+  {
+    auto var_obj = delta_obj_(v, fields);
+    if (var_obj.size())
+    {
+      var_obj["index"] = json((int64_t)index);
+      var_obj["label"] = json(v->label());
+      var_list.push_back(json(var_obj));
+    }
+  };
+  if (!delta_made_)
+  {
+    // the first delta carries every var
+    for (size_t index = 0; index < proc_ptrs_.size(); index++)
+    {
+      for (auto* v : proc_ptrs_[index]->var_ptrs_)
+      {
+        emit(index, v, delta_all_);
+      }
+    }
+    delta_made_ = true;
+  }
+  else
+  {
+    for (const auto& itr : flagged)
+    {
+      emit(itr.first, itr.second, itr.second->delta_);
+    }
+  }
+  for (const auto& itr : flagged)
+  {
+    itr.second->delta_ = 0;
+  }
+
+  json::object delta_obj;
+  delta_obj["vars"] = json(var_list);
+  return json(delta_obj);
+}
+
+bool uvw::Workspace::apply_delta(json& data)
+{
+  auto& data_obj = data.get<json::object>();
+  if (data_obj.find("vars") == data_obj.end() ||
+        !data_obj["vars"].is<json::array>())
+  {
+    return true;
+  }
+
+  // validate all entries before applying any
+  std::vector<std::pair<uvw::Variable*, json*> > entries;
+  for (auto& data_itr : data_obj["vars"].get<json::array>())
+  {
+    if (!data_itr.is<json::object>())
+    {
+      std::cerr << "Invalid delta entry!" << std::endl;
+      return false;
+    }
+    auto& var_obj = data_itr.get<json::object>();
+    if (!var_obj["index"].is<int64_t>() ||
+          !var_obj["label"].is<std::string>())
+    {
+      std::cerr << "Delta entry without proc index or var label!" <<
+        std::endl;
+      return false;
+    }
+    auto index = var_obj["index"].get<int64_t>();
+    auto label = var_obj["label"].get<std::string>();
+    if (index < 0 || index >= (int64_t)proc_ptrs_.size())
+    {
+      std::cerr << "Cannot find proc index " << index << "!" << std::endl;
+      return false;
+    }
+    uvw::Variable* v = proc_ptrs_[index]->get(label);
+    if (!v)
+    {
+      std::cerr << "Cannot find var '" << label << "'!" << std::endl;
+      return false;
+    }
+    entries.push_back({v, &data_itr});
+  }
+
+  // apply them; values failing to parse roll back the applied ones
+  std::vector<json> prev;
+  std::vector<uint8_t> prev_fields;
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    uvw::Variable* v = entries[i].first;
+    prev.push_back(json(delta_obj_(v, delta_all_)));
+    prev_fields.push_back(v->delta_ & delta_all_);
+    if (!v->patch_json(*entries[i].second))
+    {
+      for (size_t j = i + 1; j-- > 0;)
+      {
+        auto* u = entries[j].first;
+        u->patch_json(prev[j]);
+        u->delta_ = (u->delta_ & Variable::delta_listed_) | prev_fields[j];
+      }
+      return false;
+    }
+  }
+
+  // then update the base, so applied fields are not relayed back
+  for (const auto& entry : entries)
+  {
+    auto& var_obj = entry.second->get<json::object>();
+    for (const auto& field : delta_fields_)
+    {
+      if (var_obj.find(field.second) != var_obj.end())
+      {
+        entry.first->delta_ &= ~field.first;
+      }
+    }
+    if (uvw::Variable::data_lazy)
+    {
+      entry.first->touch();
+    }
+  }
+  return true;
+}
+
+json uvw::Processor::to_json()
+{
+  json::object data_obj;
+  data_obj["type"] = json(type_);
+  json::array var_list;
+  for (const auto& key : var_keys())
+  {
+    if (get(key.var_str))
+    {
+      var_list.push_back(json(get(key.var_str)->to_json()));
     }
   }
   data_obj["vars"] = json(var_list);
@@ -738,10 +3713,17 @@ bool uvw::Processor::from_json(json& data)
   return true;
 }
 
+bool uvw::Variable::assign(uvw::Variable* var)
+{
+  set_enabled(var->enabled());
+  properties = var->properties;
+  return true;
+}
+
 json uvw::Variable::to_json()
 {
   json::object data_obj;
-  data_obj["enabled"] = json(enabled);
+  data_obj["enabled"] = json(enabled_);
   data_obj["label"] = json(label());
   data_obj["type"] = json(type_str());
   if (properties.size())
@@ -758,10 +3740,16 @@ json uvw::Variable::to_json()
 
 bool uvw::Variable::from_json(json& data)
 {
-  auto& data_obj = data.get<json::object>();
   properties.clear();
+  return uvw::Variable::patch_json(data);
+}
+
+bool uvw::Variable::patch_json(json& data)
+{
+  auto& data_obj = data.get<json::object>();
   if (data_obj.find("properties") != data_obj.end())
   {
+    properties.clear();
     for (auto& itr : data_obj["properties"].get<json::object>())
     {
       properties[itr.first] = itr.second.get<int64_t>();
@@ -769,7 +3757,7 @@ bool uvw::Variable::from_json(json& data)
   }
   if (data_obj.find("enabled") != data_obj.end())
   {
-    enabled = data_obj["enabled"].get<bool>();
+    set_enabled(data_obj["enabled"].get<bool>());
   }
   return true;
 }
\ No newline at end of file
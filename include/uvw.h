@@ -3,11 +3,34 @@
 
 #include "uvw/duohash.h"
 #include "uvw/variable.h"
+#include "uvw/array.h"
 #include "uvw/workspace.h"
 #include "uvw/processor.h"
+#include "uvw/builder.h"
+#include "uvw/reload.h"
+#include "uvw/parallel.h"
+#include "uvw/stream.h"
+#include "uvw/static.h"
+
+// var types built into the library (see Variable::type_strs)
+#define UVW_BUILTIN_TYPES(X) \
+  X(int64_t) X(bool) X(double) X(std::string) \
+  X(uvw::Array<int64_t>) X(uvw::Array<double>)
+
+// explicit instantiations of a var type; prefix with extern to declare
+#define UVW_INSTANTIATE_VAR(prefix, T) \
+  prefix template class uvw::Var<T>; \
+  prefix template bool uvw::Processor::reg_var<T>( \
+    const std::string&, uvw::Var<T>&); \
+  prefix template T& uvw::Processor::ref<T>(const std::string&); \
+  prefix template T& uvw::Workspace::ref<T>(const uvw::Duohash&);
+#define UVW_EXTERN_VAR_(T) UVW_INSTANTIATE_VAR(extern, T)
 
 #ifndef UVW_BUILD_STATIC
 #include "uvw.cpp"
+#else
+// built-in var types are instantiated once, in the library (see uvw.cpp)
+UVW_BUILTIN_TYPES(UVW_EXTERN_VAR_)
 #endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,343 @@
+#ifndef UVW_ARRAY_H
+#define UVW_ARRAY_H
+
+#include "variable.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include <iostream>
+
+
+namespace uvw
+{
+  // array value with 64-byte aligned storage & row-major shape. copies are
+  // handles to the same buffer, so links (& pulls) move whole blocks with
+  // no element copies; clone() makes a deep copy. N > 0 fixes the number
+  // of elements, N == 0 sizes the array at runtime
+  template<class T, size_t N = 0>
+  class Array
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "Array elements must be trivially copyable");
+
+    protected:
+
+    std::shared_ptr<T> data_;
+    std::vector<size_t> shape_;
+    size_t size_;
+
+    static std::shared_ptr<T> alloc_(size_t n)
+    {
+      if (!n)
+      {
+        return nullptr;
+      }
+      // whole cache lines, so loops may run over aligned blocks
+      size_t bytes = (n * sizeof(T) + alignment - 1) / alignment * alignment;
+      void* ptr = nullptr;
+#if defined(__cpp_aligned_new)
+      // through operator new, so replacements see these as well
+      ptr = ::operator new(bytes, std::align_val_t(alignment));
+#elif defined(_WIN32)
+      ptr = _aligned_malloc(bytes, alignment);
+#else
+      if (posix_memalign(&ptr, alignment, bytes))
+      {
+        ptr = nullptr;
+      }
+#endif
+      if (!ptr)
+      {
+        throw std::bad_alloc();
+      }
+      std::memset(ptr, 0, bytes);
+      return std::shared_ptr<T>((T*)ptr, [](T* p)
+        {
+#if defined(__cpp_aligned_new)
+          ::operator delete(p, std::align_val_t(alignment));
+#elif defined(_WIN32)
+          _aligned_free(p);
+#else
+          std::free(p);
+#endif
+        }
+      );
+    }
+
+    public:
+
+    static const size_t alignment = 64;
+    static const size_t extent = N;
+
+    // element count of a shape; false if it overflows the allocatable
+    // bytes
+    static bool count(const std::vector<size_t>& shape, size_t& n)
+    {
+      const size_t max = (SIZE_MAX - alignment) / sizeof(T);
+      n = shape.size()? 1 : 0;
+      for (auto dim : shape)
+      {
+        if (dim && n > max / dim)
+        {
+          return false;
+        }
+        n *= dim;
+      }
+      return true;
+    }
+
+    Array(): size_(0)
+    {
+      if (N)
+      {
+        resize({N});
+      }
+    }
+    explicit Array(const std::vector<size_t>& shape): Array()
+    {
+      resize(shape);
+    }
+
+    size_t size() const {return size_;}
+    size_t bytes() const {return size_ * sizeof(T);}
+    const std::vector<size_t>& shape() const {return shape_;}
+    size_t dims() const {return shape_.size();}
+
+    T* data() {return data_.get();}
+    const T* data() const {return data_.get();}
+    T* begin() {return data();}
+    T* end() {return data() + size_;}
+    const T* begin() const {return data();}
+    const T* end() const {return data() + size_;}
+
+    T& operator[](size_t i) {return data_.get()[i];}
+    const T& operator[](size_t i) const {return data_.get()[i];}
+    // element at a row-major index of dims() entries
+    T& at(std::initializer_list<size_t> index)
+    {
+      size_t offset = 0, d = 0;
+      for (auto i : index)
+      {
+        offset = offset * shape_[d++] + i;
+      }
+      return data_.get()[offset];
+    }
+
+    // new zeroed buffer if the element count changes; false if fixed-size
+    // & the count differs from N, or if it overflows
+    bool resize(const std::vector<size_t>& shape)
+    {
+      size_t n;
+      if (!count(shape, n) || (N && n != N))
+      {
+        return false;
+      }
+      if (n != size_ || !data_)
+      {
+        data_ = alloc_(n);
+        size_ = n;
+      }
+      shape_ = shape;
+      return true;
+    }
+    // new shape over the same buffer & element count
+    bool reshape(const std::vector<size_t>& shape)
+    {
+      size_t n;
+      if (!count(shape, n) || n != size_)
+      {
+        return false;
+      }
+      shape_ = shape;
+      return true;
+    }
+
+    Array clone() const
+    {
+      Array a;
+      a.resize(shape_);
+      if (size_)
+      {
+        std::memcpy(a.data(), data(), bytes());
+      }
+      return a;
+    }
+    // copy shape & elements into this buffer; reallocates on a size change
+    bool copy(const Array& a)
+    {
+      if (a.data_ == data_)
+      {
+        shape_ = a.shape_;
+        return true;
+      }
+      if (!resize(a.shape_))
+      {
+        return false;
+      }
+      if (size_)
+      {
+        std::memcpy(data(), a.data(), bytes());
+      }
+      return true;
+    }
+    bool shares(const Array& a) const {return data_ && a.data_ == data_;}
+
+    bool operator==(const Array& a) const
+    {
+      return shape_ == a.shape_ && (data_ == a.data_ ||
+        !size_ || !std::memcmp(data(), a.data(), bytes()));
+    }
+    bool operator!=(const Array& a) const {return !(*this == a);}
+
+    // binary serialization; dims, shape & raw elements (native layout)
+    void save(std::vector<char>& buf) const
+    {
+      uint64_t dims = shape_.size();
+      buf.insert(buf.end(), (const char*)&dims, (const char*)&dims + 8);
+      for (uint64_t dim : shape_)
+      {
+        buf.insert(buf.end(), (const char*)&dim, (const char*)&dim + 8);
+      }
+      auto* elems = (const char*)data();
+      buf.insert(buf.end(), elems, elems + bytes());
+    }
+    // returns the number of bytes consumed, or 0 on failure; elements are
+    // loaded in place if the element count is unchanged
+    size_t load(const char* buf, size_t size)
+    {
+      uint64_t dims;
+      if (size < 8)
+      {
+        return 0;
+      }
+      std::memcpy(&dims, buf, 8);
+      if ((size - 8) / 8 < dims)
+      {
+        return 0;
+      }
+      std::vector<size_t> shape(dims);
+      for (size_t d = 0; d < dims; d++)
+      {
+        uint64_t dim;
+        std::memcpy(&dim, buf + 8 + d * 8, 8);
+        shape[d] = dim;
+      }
+      size_t offset = 8 + dims * 8;
+      size_t n;
+      if (!count(shape, n) || (size - offset) / sizeof(T) < n ||
+        !resize(shape))
+      {
+        return 0;
+      }
+      if (n)
+      {
+        std::memcpy(data(), buf + offset, bytes());
+      }
+      return offset + bytes();
+    }
+
+    // codec for Variable::state_codecs
+    static StateCodec codec()
+    {
+      return {
+        [](const void* data, std::vector<char>& buf)
+        {
+          ((const Array*)data)->save(buf);
+        },
+        [](void* data, const char* buf, size_t size) -> size_t
+        {
+          return ((Array*)data)->load(buf, size);
+        }
+      };
+    }
+  };
+
+  // json as {"shape": [...], "data": [...]}; a flat array is read as 1-D.
+  // state copies (assign, copy_value) are deep, unlike links
+  template<class T, size_t N>
+  struct ValueTraits<Array<T, N> >
+  {
+    static json to_json(const Array<T, N>& val)
+    {
+      json::array shape, elems;
+      for (auto dim : val.shape())
+      {
+        shape.push_back(json((int64_t)dim));
+      }
+      for (const auto& elem : val)
+      {
+        elems.push_back(ValueTraits<T>::to_json(elem));
+      }
+      json::object obj;
+      obj["shape"] = json(shape);
+      obj["data"] = json(elems);
+      return json(obj);
+    }
+
+    static bool from_json(const json& data, Array<T, N>& out)
+    {
+      Array<T, N> val;
+      const json::array* elems = nullptr;
+      std::vector<size_t> shape;
+      bool valid = true;
+      if (data.is<json::array>())
+      {
+        elems = &data.get<json::array>();
+        shape = {elems->size()};
+      }
+      else if (data.is<json::object>())
+      {
+        auto& obj = data.get<json::object>();
+        auto itr = obj.find("data");
+        if (itr != obj.end() && itr->second.is<json::array>())
+        {
+          elems = &itr->second.get<json::array>();
+          shape = {elems->size()};
+        }
+        itr = obj.find("shape");
+        if (itr != obj.end() && itr->second.is<json::array>())
+        {
+          shape.clear();
+          for (auto& dim : itr->second.get<json::array>())
+          {
+            if (!dim.is<int64_t>() || dim.get<int64_t>() < 0)
+            {
+              valid = false;
+              break;
+            }
+            shape.push_back(dim.get<int64_t>());
+          }
+        }
+      }
+      // the shape must match the data before allocating
+      size_t n;
+      if (!valid || !elems || !Array<T, N>::count(shape, n) ||
+        n != elems->size() || !val.resize(shape))
+      {
+        std::cerr << "Failure: invalid array data!" << std::endl;
+        return false;
+      }
+      for (size_t i = 0; i < elems->size(); i++)
+      {
+        if (!ValueTraits<T>::from_json((*elems)[i], val[i]))
+        {
+          std::cerr << "Failure: invalid array data!" << std::endl;
+          return false;
+        }
+      }
+      out = std::move(val);
+      return true;
+    }
+
+    static void copy(Array<T, N>& dst, const Array<T, N>& src)
+    {
+      dst.copy(src);
+    }
+  };
+};
+
+#endif
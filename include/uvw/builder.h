@@ -0,0 +1,44 @@
+#ifndef UVW_BUILDER_H
+#define UVW_BUILDER_H
+
+#include "duohash.h"
+#include "variable.h"
+#include "workspace.h"
+
+#include <string>
+#include <vector>
+
+
+namespace uvw
+{
+  // bulk graph construction for a workspace: reserves registry capacity,
+  // creates procs & records links, then hooks up all links & schedules
+  // once on commit
+  class Builder
+  {
+    protected:
+
+    Workspace& ws_;
+    size_t n_procs_;
+    std::vector<std::pair<Duohash, Duohash> > links_;
+    Duohash in_, out_;
+
+    void reserve_(size_t n_vars, const std::string& proc_type);
+
+    public:
+
+    Builder(Workspace& ws, size_t n_procs = 0, size_t n_links = 0);
+    Builder(const Builder&) = delete;
+    Builder& operator=(const Builder&) = delete;
+
+    Processor* add(const std::string& proc_type);
+    void link(const Duohash& src, const Duohash& dst);
+    void set_input(const Duohash& key) {in_ = key;}
+    void set_output(const Duohash& key) {out_ = key;}
+
+    // all-or-nothing: no link is made if any recorded link is invalid
+    bool commit();
+  };
+};
+
+#endif
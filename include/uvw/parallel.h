@@ -0,0 +1,153 @@
+#ifndef UVW_PARALLEL_H
+#define UVW_PARALLEL_H
+
+#include "variable.h"
+#include "workspace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace uvw
+{
+  // multi-threaded processing of a workspace seq: procs start as soon as
+  // the procs they pull from are done. ready procs are started in seq
+  // order (FIFO), or by the longest remaining path of measured proc costs
+  // to the end of the frame (CRITICAL_PATH), so long dependency chains are
+  // not held back by cheap independent procs. costs are moving averages
+  // of wall time per proc, unit until measured. the calling thread is one
+  // of the workers; lazy evaluation is not supported while processing
+  class Parallel
+  {
+    public:
+
+    enum Policy {FIFO, CRITICAL_PATH};
+
+    protected:
+
+    Workspace& ws_;
+    Policy policy_;
+
+    // dependency graph of the seq, by seq index
+    struct Node
+    {
+      std::vector<size_t> outs;
+      size_t ins;
+      // measured cost in seconds; remaining critical path incl. the cost
+      double cost;
+      double rank;
+      bool measured;
+      // placement partition
+      size_t part;
+    };
+    std::vector<Processor*> seq_;
+    std::vector<Node> nodes_;
+    Workspace::Pulls pulls_;
+    Workspace::Stamp stamp_;
+    bool plan_();
+    void rank_();
+
+    // placement: cpus & their numa nodes, the partition of each worker
+    // (the caller is worker 0), & var storage first touched per partition
+    std::vector<int> cpus_;
+    std::vector<int> cpu_nodes_;
+    std::vector<int> part_nodes_;
+    std::vector<size_t> worker_parts_;
+    std::vector<std::vector<char> > homes_;
+    std::vector<std::pair<Duohash, Variable*> > homed_;
+    void partition_();
+    void home_();
+    void unhome_();
+    static bool pin_(std::thread::native_handle_type thread,
+      const std::vector<int>& cpus);
+
+    // frame states; ready procs are queued per partition
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::deque<size_t> > fifos_;
+    std::vector<std::vector<size_t> > heaps_;
+    size_t ready_;
+    // pruned procs of the workspace, by seq index
+    const std::vector<char>* skip_;
+    std::vector<size_t> pending_;
+    // procs processed in the frame, to notify subscriptions of after it
+    std::vector<char> processed_;
+    size_t remaining_;
+    size_t running_;
+    bool failed_;
+    bool preprocess_;
+    bool stopping_;
+    std::vector<std::thread> workers_;
+    bool done_() const {return !remaining_ || (failed_ && !running_);}
+    void push_(size_t i);
+    size_t pop_(size_t part);
+    void work_(size_t worker);
+
+    public:
+
+    // threads incl. the caller; hardware concurrency if 0
+    Parallel(Workspace& ws, size_t threads = 0, Policy policy = FIFO);
+    ~Parallel();
+    Parallel(const Parallel&) = delete;
+    Parallel& operator=(const Parallel&) = delete;
+
+    Policy policy() const {return policy_;}
+    void set_policy(Policy policy) {policy_ = policy;}
+    size_t threads() const {return workers_.size() + 1;}
+
+    // process the workspace seq; re-planned when the seq, links or the
+    // var registry change
+    bool process(bool preprocess = false);
+
+    // per seq index; valid after process
+    const std::vector<Processor*>& seq() const {return seq_;}
+    double cost(size_t i) const {return nodes_[i].cost;}
+    double rank(size_t i) const {return nodes_[i].rank;}
+    // longest path of costs through the seq
+    double critical_path() const;
+    // weight of the latest cost in the moving averages
+    double decay;
+
+    // pin workers round-robin to cpus (the caller while processing) &
+    // split the seq into contiguous partitions per numa node, weighted by
+    // costs & cpus per node. workers take ready procs of their node first,
+    // & trivially copyable vars of each partition are moved into storage
+    // first touched on its node (not when packed, see Workspace::pack).
+    // nodes are looked up per cpu unless given; cpus outside of the
+    // process affinity are dropped, & without numa info all cpus are on
+    // node 0. fails if no cpu is usable
+    bool place(const std::vector<int>& cpus,
+      const std::vector<int>& nodes = {});
+    // unpin workers & restore var storage
+    void unplace();
+    bool placed() const {return cpus_.size() > 0;}
+    // distinct nodes of the placement; partition of a seq index
+    size_t parts() const {return std::max<size_t>(part_nodes_.size(), 1);}
+    size_t part(size_t i) const {return nodes_[i].part;}
+    int part_node(size_t part) const
+    {
+      return part < part_nodes_.size()? part_nodes_[part] : 0;
+    }
+    // links between procs of different partitions; prone to remote access
+    std::vector<std::pair<Duohash, Duohash> > remote_links() const;
+
+    // numa node of a cpu, 0 if unknown
+    static int cpu_node(int cpu);
+  };
+};
+
+#endif
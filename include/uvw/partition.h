@@ -0,0 +1,767 @@
+#ifndef UVW_PARTITION_H
+#define UVW_PARTITION_H
+
+#include "variable.h"
+#include "processor.h"
+#include "workspace.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+
+namespace uvw
+{
+  // message channel between a partition coordinator & a worker
+  class Transport
+  {
+    public:
+
+    virtual ~Transport() {}
+    virtual bool send(const std::vector<char>& msg) = 0;
+    virtual bool recv(std::vector<char>& msg) = 0;
+  };
+
+  // length-prefixed messages over a connected stream socket; Unix domain
+  // sockets locally, though any stream fd (e.g. TCP) works the same
+  class SocketTransport : public Transport
+  {
+    protected:
+
+    int fd_;
+
+    bool write_(const char* buf, size_t size);
+    bool read_(char* buf, size_t size);
+
+    public:
+
+    SocketTransport(int fd = -1): fd_(fd) {}
+    ~SocketTransport() {close();}
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    // connected pair of local sockets
+    static bool pair(SocketTransport& a, SocketTransport& b);
+    // client & server ends of a Unix domain socket path
+    bool connect(const std::string& path);
+    static int listen(const std::string& path, int backlog = 16);
+    bool accept(int listen_fd);
+
+    void close();
+    int fd() const {return fd_;}
+    bool is_open() const {return fd_ >= 0;}
+
+    bool send(const std::vector<char>& msg) override;
+    bool recv(std::vector<char>& msg) override;
+  };
+
+  // partitioned execution of a workspace over worker processes. the seq is
+  // cut into contiguous parts, so links only cross from earlier parts into
+  // later ones; each worker holds the whole definition but processes its
+  // own part only. values of vars read across parts (chain heads of the
+  // crossing links), of the input & of the output are relayed through the
+  // coordinator each frame, & frames are pipelined over the parts. edits
+  // made on the coordinator's workspace (values, enums & enabled flags set
+  // outside of processing) travel with the next frame as deltas; see
+  // Workspace::to_delta, which is drained by the partition while started
+  class Partition
+  {
+    public:
+
+    struct Plan
+    {
+      // seq range per part; part i runs [begins[i], begins[i + 1])
+      std::vector<size_t> begins;
+      // relayed vars & their producing part; the coordinator counts as
+      // part n (producing the input & consuming the output)
+      std::vector<Variable*> vars;
+      std::vector<size_t> owners;
+      // relayed var indices consumed per part, coordinator last
+      std::vector<std::vector<size_t> > imports;
+      // links crossing parts
+      size_t links = 0;
+    };
+
+    // cut the seq of a workspace into n parts of about equal proc counts
+    static bool plan(Workspace& ws, size_t n, Plan& res);
+
+    // worker loop over a transport; ws must hold the same definition &
+    // output as the coordinator's. returns once stopped or disconnected
+    static bool serve(Workspace& ws, Transport& t);
+
+    protected:
+
+    enum Message : uint32_t {SETUP = 1, RUN, DONE, FAIL, STOP};
+
+    // frames in flight; encoded values per relayed var & the coordinator's
+    // edits made before the frame entered, if any
+    struct Frame
+    {
+      size_t index;
+      std::vector<std::vector<char> > values;
+      std::string delta;
+    };
+
+    Workspace& ws_;
+    Plan plan_;
+    std::vector<std::unique_ptr<Transport> > workers_;
+    std::vector<pid_t> pids_;
+    std::deque<Frame> frames_;
+
+    static bool encode_(Variable* v, std::vector<char>& buf);
+    static bool decode_(Variable* v, const char* buf, size_t size);
+    static void header_(std::vector<char>& msg, uint32_t type,
+      uint64_t frame, uint32_t count);
+    static bool read_(std::vector<char>& msg, size_t& offset, void* dst,
+      size_t size);
+    static bool apply_(const Plan& plan, std::vector<char>& msg,
+      size_t offset, uint32_t count, Frame* frame);
+
+    bool run_(size_t frames, bool preprocess,
+      const std::function<bool(size_t)>& feed,
+      const std::function<bool(size_t)>& drain);
+
+    public:
+
+    Partition(Workspace& ws): ws_(ws) {}
+    ~Partition() {stop();}
+    Partition(const Partition&) = delete;
+    Partition& operator=(const Partition&) = delete;
+
+    // plan n parts & fork a worker process per part over local sockets
+    bool spawn(size_t n);
+    // plan a part per connected worker (e.g. remote workers running serve)
+    bool start(std::vector<std::unique_ptr<Transport> > workers);
+    // stop & join the workers; returns false if any worker failed
+    bool stop();
+
+    size_t size() const {return workers_.size();}
+    const Plan& plan() const {return plan_;}
+
+    // one frame through all parts; the output lands in the workspace
+    bool process(bool preprocess = false);
+    // pipelined frames; feed(f) is called before frame f enters the first
+    // part (e.g. to set the input), drain(f) once its output is available
+    bool run(size_t frames,
+      const std::function<bool(size_t)>& feed = nullptr,
+      const std::function<bool(size_t)>& drain = nullptr);
+  };
+};
+
+// implementation
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+inline bool uvw::SocketTransport::write_(const char* buf, size_t size)
+{
+  while (size)
+  {
+    ssize_t n = ::send(fd_, buf, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (n <= 0)
+    {
+      return false;
+    }
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+inline bool uvw::SocketTransport::read_(char* buf, size_t size)
+{
+  while (size)
+  {
+    ssize_t n = ::recv(fd_, buf, size, 0);
+    if (n < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (n <= 0)
+    {
+      return false;
+    }
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+inline bool uvw::SocketTransport::pair(SocketTransport& a, SocketTransport& b)
+{
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+  {
+    return false;
+  }
+  a.close();
+  b.close();
+  a.fd_ = fds[0];
+  b.fd_ = fds[1];
+  return true;
+}
+
+inline bool uvw::SocketTransport::connect(const std::string& path)
+{
+  close();
+  sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path))
+  {
+    return false;
+  }
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd_ < 0 || ::connect(fd_, (sockaddr*)&addr, sizeof(addr)) != 0)
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+inline int uvw::SocketTransport::listen(const std::string& path, int backlog)
+{
+  sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path))
+  {
+    return -1;
+  }
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+  {
+    return -1;
+  }
+  if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(fd, backlog) != 0)
+  {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+inline bool uvw::SocketTransport::accept(int listen_fd)
+{
+  close();
+  do
+  {
+    fd_ = ::accept(listen_fd, nullptr, nullptr);
+  }
+  while (fd_ < 0 && errno == EINTR);
+  return fd_ >= 0;
+}
+
+inline void uvw::SocketTransport::close()
+{
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+inline bool uvw::SocketTransport::send(const std::vector<char>& msg)
+{
+  uint64_t size = msg.size();
+  return (
+    fd_ >= 0 &&
+    write_((const char*)&size, 8) &&
+    write_(msg.data(), msg.size())
+  );
+}
+
+inline bool uvw::SocketTransport::recv(std::vector<char>& msg)
+{
+  uint64_t size;
+  if (fd_ < 0 || !read_((char*)&size, 8))
+  {
+    return false;
+  }
+  msg.resize(size);
+  return read_(msg.data(), size);
+}
+
+// Partition impl.
+
+inline bool uvw::Partition::plan(Workspace& ws, size_t n, Plan& res)
+{
+  res = Plan();
+  const auto& seq = ws.seq();
+  if (!n || seq.size() < n)
+  {
+    std::cerr << "Failure: cannot cut " << seq.size() << " procs into " <<
+      n << " parts!" << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i <= n; i++)
+  {
+    res.begins.push_back(seq.size() * i / n);
+  }
+  std::unordered_map<Processor*, size_t> parts;
+  for (size_t i = 0; i < n; i++)
+  {
+    for (size_t j = res.begins[i]; j < res.begins[i + 1]; j++)
+    {
+      parts[seq[j]] = i;
+    }
+  }
+
+  std::unordered_map<Variable*, size_t> indices;
+  std::vector<std::unordered_set<size_t> > imports(n + 1);
+  auto relay = [&](Variable* v, size_t owner, size_t part)
+  {
+    auto itr = indices.find(v);
+    if (itr == indices.end())
+    {
+      itr = indices.insert({v, res.vars.size()}).first;
+      res.vars.push_back(v);
+      res.owners.push_back(owner);
+    }
+    imports[part].insert(itr->second);
+  };
+
+  // the input first, so parts reading it through links import it from the
+  // coordinator too
+  Variable* in = Workspace::get(ws.in_);
+  if (in && parts.count(in->proc()))
+  {
+    relay(in, n, parts[in->proc()]);
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    for (size_t j = res.begins[i]; j < res.begins[i + 1]; j++)
+    {
+      for (auto* v : seq[j]->var_ptrs())
+      {
+        if (!Workspace::has(v->src()))
+        {
+          continue;
+        }
+        // values are read from the chain head
+        Variable* head = Workspace::get(v->src());
+        for (size_t k = 0; k < Workspace::vars_.size() &&
+              Workspace::has(head->src()); k++)
+        {
+          head = Workspace::get(head->src());
+        }
+        auto itr = parts.find(head->proc());
+        if (itr != parts.end() && itr->second != i)
+        {
+          relay(head, itr->second, i);
+          res.links++;
+        }
+      }
+    }
+  }
+
+  Variable* out = Workspace::get(ws.out_);
+  if (out && parts.count(out->proc()))
+  {
+    relay(out, parts[out->proc()], n);
+  }
+
+  for (auto& part_imports : imports)
+  {
+    res.imports.emplace_back(part_imports.begin(), part_imports.end());
+    std::sort(res.imports.back().begin(), res.imports.back().end());
+  }
+  return true;
+}
+
+inline bool uvw::Partition::encode_(Variable* v, std::vector<char>& buf)
+{
+  if (v->is_trivial())
+  {
+    const char* data = (const char*)v->raw_data();
+    buf.insert(buf.end(), data, data + v->data_size());
+    return true;
+  }
+  auto itr = uvw::Variable::state_codecs.find(v->type_index());
+  if (itr == uvw::Variable::state_codecs.end())
+  {
+    std::cerr << "No state codec for var " << v->key() << "!" << std::endl;
+    return false;
+  }
+  itr->second.save(v->raw_data(), buf);
+  return true;
+}
+
+inline bool uvw::Partition::decode_(Variable* v, const char* buf, size_t size)
+{
+  if (v->is_trivial())
+  {
+    if (size != v->data_size())
+    {
+      return false;
+    }
+    std::memcpy(v->raw_data(), buf, size);
+    return true;
+  }
+  auto itr = uvw::Variable::state_codecs.find(v->type_index());
+  return (
+    itr != uvw::Variable::state_codecs.end() &&
+    itr->second.load(v->raw_data(), buf, size) == size
+  );
+}
+
+inline void uvw::Partition::header_(std::vector<char>& msg, uint32_t type,
+  uint64_t frame, uint32_t count)
+{
+  msg.clear();
+  msg.insert(msg.end(), (const char*)&type, (const char*)&type + 4);
+  msg.insert(msg.end(), (const char*)&frame, (const char*)&frame + 8);
+  msg.insert(msg.end(), (const char*)&count, (const char*)&count + 4);
+}
+
+inline bool uvw::Partition::read_(std::vector<char>& msg, size_t& offset,
+  void* dst, size_t size)
+{
+  if (msg.size() < offset || msg.size() - offset < size)
+  {
+    return false;
+  }
+  std::memcpy(dst, msg.data() + offset, size);
+  offset += size;
+  return true;
+}
+
+// message entries: relayed var index, value size & encoded value
+inline bool uvw::Partition::apply_(const Plan& plan, std::vector<char>& msg,
+  size_t offset, uint32_t count, Frame* frame)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t index;
+    uint64_t size;
+    if (!read_(msg, offset, &index, 4) || !read_(msg, offset, &size, 8) ||
+          index >= plan.vars.size() || msg.size() - offset < size)
+    {
+      return false;
+    }
+    const char* data = msg.data() + offset;
+    if (frame)
+    {
+      frame->values[index].assign(data, data + size);
+    }
+    else if (!decode_(plan.vars[index], data, size))
+    {
+      return false;
+    }
+    offset += size;
+  }
+  return true;
+}
+
+inline bool uvw::Partition::serve(Workspace& ws, Transport& t)
+{
+  std::vector<char> msg;
+  uint32_t type, count;
+  uint64_t frame, part, n;
+  size_t offset = 0;
+  if (!t.recv(msg) || !read_(msg, offset, &type, 4) || type != SETUP ||
+        !read_(msg, offset, &frame, 8) || !read_(msg, offset, &count, 4) ||
+        !read_(msg, offset, &part, 8) || !read_(msg, offset, &n, 8))
+  {
+    return false;
+  }
+
+  Plan plan;
+  bool res = Partition::plan(ws, n, plan) && part < n;
+  std::vector<Processor*> seq;
+  std::vector<size_t> exports;
+  if (res)
+  {
+    seq.assign(ws.seq().begin() + plan.begins[part],
+      ws.seq().begin() + plan.begins[part + 1]);
+    for (size_t i = 0; i < plan.vars.size(); i++)
+    {
+      if (plan.owners[i] == part)
+      {
+        exports.push_back(i);
+      }
+    }
+  }
+  Workspace::Pulls pulls;
+
+  while (t.recv(msg))
+  {
+    offset = 0;
+    if (!read_(msg, offset, &type, 4) || !read_(msg, offset, &frame, 8) ||
+          !read_(msg, offset, &count, 4))
+    {
+      return false;
+    }
+    if (type == STOP)
+    {
+      return res;
+    }
+    uint32_t preprocess = 0;
+    uint64_t delta_size = 0;
+    bool ok = (
+      res && type == RUN &&
+      read_(msg, offset, &preprocess, 4) &&
+      read_(msg, offset, &delta_size, 8) &&
+      msg.size() - offset >= delta_size
+    );
+    if (ok)
+    {
+      std::lock_guard<std::recursive_mutex> lock(Workspace::mutex_);
+      if (delta_size)
+      {
+        json delta;
+        std::string str(msg.data() + offset, delta_size);
+        ok = picojson::parse(delta, str).empty() &&
+          delta.is<json::object>() && ws.apply_delta(delta);
+        offset += delta_size;
+      }
+      ok = ok && apply_(plan, msg, offset, count, nullptr) &&
+        Workspace::execute_(seq, &pulls, preprocess);
+    }
+
+    header_(msg, ok? DONE : FAIL, frame, ok? exports.size() : 0);
+    for (size_t i = 0; ok && i < exports.size(); i++)
+    {
+      uint32_t index = exports[i];
+      msg.insert(msg.end(), (const char*)&index, (const char*)&index + 4);
+      size_t at = msg.size();
+      msg.resize(at + 8);
+      ok = encode_(plan.vars[index], msg);
+      uint64_t size = msg.size() - at - 8;
+      std::memcpy(msg.data() + at, &size, 8);
+    }
+    if (!ok)
+    {
+      header_(msg, FAIL, frame, 0);
+    }
+    if (!t.send(msg))
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+inline bool uvw::Partition::spawn(size_t n)
+{
+  stop();
+  Plan plan;
+  if (!Partition::plan(ws_, n, plan))
+  {
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Transport> > workers;
+  std::vector<pid_t> pids;
+  for (size_t i = 0; i < n; i++)
+  {
+    std::unique_ptr<SocketTransport> parent(new SocketTransport());
+    SocketTransport child;
+    if (!SocketTransport::pair(*parent, child))
+    {
+      break;
+    }
+    // workers inherit the workspace as is
+    std::cout << std::flush;
+    std::cerr << std::flush;
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      parent->close();
+      workers.clear();
+      _exit(serve(ws_, child)? 0 : 1);
+    }
+    if (pid < 0)
+    {
+      break;
+    }
+    pids.push_back(pid);
+    workers.push_back(std::move(parent));
+  }
+
+  bool res = (workers.size() == n) && start(std::move(workers));
+  pids_ = pids;
+  if (!res)
+  {
+    stop();
+  }
+  return res;
+}
+
+inline bool uvw::Partition::start(
+  std::vector<std::unique_ptr<Transport> > workers
+)
+{
+  if (!Partition::plan(ws_, workers.size(), plan_))
+  {
+    return false;
+  }
+  workers_ = std::move(workers);
+  frames_.clear();
+  // workers start from the workspace as is
+  ws_.to_delta();
+
+  std::vector<char> msg;
+  for (uint64_t i = 0; i < workers_.size(); i++)
+  {
+    uint64_t n = workers_.size();
+    header_(msg, SETUP, 0, 0);
+    msg.insert(msg.end(), (const char*)&i, (const char*)&i + 8);
+    msg.insert(msg.end(), (const char*)&n, (const char*)&n + 8);
+    if (!workers_[i]->send(msg))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline bool uvw::Partition::stop()
+{
+  bool res = true;
+  std::vector<char> msg;
+  header_(msg, STOP, 0, 0);
+  for (auto& worker : workers_)
+  {
+    worker->send(msg);
+  }
+  workers_.clear();
+  for (auto pid : pids_)
+  {
+    int status = -1;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+    res = res && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  pids_.clear();
+  frames_.clear();
+  return res;
+}
+
+inline bool uvw::Partition::process(bool preprocess)
+{
+  return run_(1, preprocess, nullptr, nullptr);
+}
+
+inline bool uvw::Partition::run(size_t frames,
+  const std::function<bool(size_t)>& feed,
+  const std::function<bool(size_t)>& drain)
+{
+  return run_(frames, false, feed, drain);
+}
+
+inline bool uvw::Partition::run_(size_t frames, bool preprocess,
+  const std::function<bool(size_t)>& feed,
+  const std::function<bool(size_t)>& drain)
+{
+  size_t n = workers_.size();
+  if (!n)
+  {
+    return false;
+  }
+  bool res = true;
+  std::vector<char> msg;
+  // at step t, part i runs frame t - i; frames_ holds frames in flight
+  for (size_t t = 0; t < frames + n - 1; t++)
+  {
+    size_t first = (t < frames)? 0 : t - frames + 1;
+    size_t last = std::min(t, n - 1);
+    for (size_t i = first; i <= last; i++)
+    {
+      size_t f = t - i;
+      if (i == 0)
+      {
+        res = (!feed || feed(f)) && res;
+        frames_.push_back({f, std::vector<std::vector<char> >(
+          plan_.vars.size()), std::string()});
+        auto delta = ws_.to_delta();
+        if (delta.get<json::object>()["vars"].get<json::array>().size())
+        {
+          frames_.back().delta = delta.serialize();
+        }
+        // the input is captured as the frame enters
+        for (size_t k = 0; k < plan_.vars.size(); k++)
+        {
+          if (plan_.owners[k] == n)
+          {
+            res = encode_(plan_.vars[k], frames_.back().values[k]) && res;
+          }
+        }
+      }
+      Frame& frame = frames_[f - frames_.front().index];
+
+      header_(msg, RUN, f, plan_.imports[i].size());
+      uint32_t flag = preprocess;
+      msg.insert(msg.end(), (const char*)&flag, (const char*)&flag + 4);
+      uint64_t delta_size = frame.delta.size();
+      msg.insert(msg.end(), (const char*)&delta_size,
+        (const char*)&delta_size + 8);
+      msg.insert(msg.end(), frame.delta.begin(), frame.delta.end());
+      for (size_t k : plan_.imports[i])
+      {
+        uint32_t index = k;
+        uint64_t size = frame.values[k].size();
+        msg.insert(msg.end(), (const char*)&index, (const char*)&index + 4);
+        msg.insert(msg.end(), (const char*)&size, (const char*)&size + 8);
+        msg.insert(msg.end(), frame.values[k].begin(), frame.values[k].end());
+      }
+      if (!workers_[i]->send(msg))
+      {
+        stop();
+        return false;
+      }
+    }
+
+    // collect in the same order; workers run concurrently meanwhile
+    for (size_t i = first; i <= last; i++)
+    {
+      Frame& frame = frames_[t - i - frames_.front().index];
+      uint32_t type, count;
+      uint64_t f;
+      size_t offset = 0;
+      if (!workers_[i]->recv(msg) || !read_(msg, offset, &type, 4) ||
+            !read_(msg, offset, &f, 8) || !read_(msg, offset, &count, 4) ||
+            f != frame.index)
+      {
+        stop();
+        return false;
+      }
+      res = (type == DONE && apply_(plan_, msg, offset, count, &frame)) &&
+        res;
+    }
+
+    // the oldest frame left the last part
+    if (last == n - 1)
+    {
+      Frame& frame = frames_.front();
+      for (size_t k : plan_.imports[n])
+      {
+        auto& value = frame.values[k];
+        res = decode_(plan_.vars[k], value.data(), value.size()) && res;
+      }
+      res = (!drain || drain(frame.index)) && res;
+      frames_.pop_front();
+    }
+  }
+  return res;
+}
+
+#endif
@@ -10,16 +10,32 @@
 namespace uvw
 {
   class Workspace;
+  class SharedStore;
+  class Parallel;
 
   class Processor
   {
     friend class Workspace;
+    friend class SharedStore;
+    friend class Variable;
+    friend class Parallel;
 
     protected:
 
     std::vector<Duohash> var_keys_;
+    std::vector<Variable*> var_ptrs_;
     std::string type_;
 
+    // lazy evaluation states
+    bool stale_;
+    bool busy_;
+    // owns vars backed by shared storage
+    bool shared_;
+    // vars with change subscriptions
+    size_t watched_;
+    // version of the owning workspace (see Workspace::Stamp)
+    std::shared_ptr<uint64_t> version_;
+
     public:
     
     Processor();
@@ -31,6 +47,14 @@ namespace uvw
     virtual bool initialize() {return true;}
     virtual bool preprocess() {return true;}
     virtual bool process(bool preprocess=false) {return true;}
+    // restore a cleared proc for reuse; return true to opt into pooling
+    virtual bool reset() {return false;}
+    // fill the kernel & return true to declare the proc fusible; kernels
+    // must be equivalent to preprocess & process; see Workspace::fuse
+    virtual bool kernel(Kernel&) {return false;}
+    // copy internal states not held by vars from a proc of the same type;
+    // see Workspace::clone
+    virtual bool assign(Processor*) {return true;}
 
     template<typename T>
     bool reg_var(const std::string& label, Var<T>& var);
@@ -43,6 +67,8 @@ namespace uvw
 
     const std::string& type_str() const {return type_;}
     const std::vector<Duohash>& var_keys() const {return var_keys_;}
+    const std::vector<Variable*>& var_ptrs() const {return var_ptrs_;}
+    bool stale() const {return stale_;}
   };
 
 };
@@ -76,6 +102,7 @@ bool uvw::Processor::reg_var(const std::string& label, Var<T>& v)
   }
 
   var_keys_.push_back(key);
+  var_ptrs_.push_back(&v);
 
   return true;
 }
@@ -0,0 +1,63 @@
+#ifndef UVW_RELOAD_H
+#define UVW_RELOAD_H
+
+#include "variable.h"
+#include "workspace.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+
+namespace uvw
+{
+  // double-buffered reload of a live workspace: a new definition is built
+  // & preprocessed on a background thread, values of vars matching by proc
+  // index & label are carried over, then swap() exchanges it with the live
+  // workspace in constant time; the replaced procs are cleared in the
+  // background as well. while a reload is busy, the live workspace is to
+  // be driven through process() & direct var reads/writes only; lazy
+  // evaluation & other registry changes are not synchronized
+  class Reload
+  {
+    protected:
+
+    Workspace& ws_;
+    Workspace next_;
+    std::thread worker_;
+
+    std::atomic<bool> busy_;
+    std::atomic<bool> ready_;
+    // build result; released once swapped or dropped
+    std::future<bool> built_;
+    std::promise<void> release_;
+    bool released_;
+
+    void run_(json data, std::promise<bool> built, std::future<void> release);
+    bool build_(json& data);
+    void carry_over_();
+
+    public:
+
+    Reload(Workspace& ws);
+    ~Reload();
+    Reload(const Reload&) = delete;
+    Reload& operator=(const Reload&) = delete;
+
+    // start building a new definition; fails if a reload is in progress
+    bool start(const json& data);
+    bool start(const std::string& str);
+
+    // built & preprocessed, awaiting swap
+    bool ready() const {return ready_;}
+    // building, awaiting swap or clearing the replaced procs
+    bool busy() const {return busy_;}
+    // block until the build finishes; returns ready()
+    bool wait();
+
+    // swap the new workspace in if ready; call between frames
+    bool swap();
+  };
+};
+
+#endif
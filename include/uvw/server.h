@@ -0,0 +1,435 @@
+#ifndef UVW_SERVER_H
+#define UVW_SERVER_H
+
+#include "variable.h"
+#include "processor.h"
+#include "workspace.h"
+#include "partition.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace uvw
+{
+  // execution service hosting named workspaces over a Unix domain socket.
+  // requests & replies are json messages (see SocketTransport framing):
+  //
+  //   {"graph": <name>, "vars": [<delta entries>], "run": true,
+  //     "preprocess": false,
+  //     "get": [{"index": <proc index>, "label": <var label>}, ...]}
+  //   -> {"ok": true, "values": [<value>, ...]}
+  //
+  // where vars are applied as in Workspace::apply_delta, & graphs are
+  // preprocessed once on load. a single executor
+  // owns all workspaces (the registry is global); pending requests are
+  // taken in batches, & consecutive requests of a graph with identical
+  // vars share one run. {"stats": true} returns request & run counts
+  class Server
+  {
+    protected:
+
+    struct Request
+    {
+      json data;
+      // coalescing key; serialized vars & run flags
+      std::string key;
+      std::promise<std::string> reply;
+    };
+
+    std::map<std::string, std::unique_ptr<Workspace> > graphs_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request*> queue_;
+    bool stopping_;
+
+    int listen_fd_;
+    std::string path_;
+    std::thread acceptor_;
+    std::thread executor_;
+    // connection threads & their fds, -1 once finished
+    mutable std::mutex conns_mutex_;
+    std::vector<std::thread> conns_;
+    std::vector<int> conn_fds_;
+
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> runs_;
+    std::atomic<uint64_t> batches_;
+
+    void accept_();
+    void serve_(int fd);
+    void execute_();
+    std::string reply_(Workspace& ws, json& data, bool ok);
+
+    public:
+
+    Server(): stopping_(false), listen_fd_(-1),
+      requests_(0), runs_(0), batches_(0) {}
+    ~Server() {stop();}
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // host & preprocess a workspace definition (see Workspace::from_str);
+    // before start
+    bool load(const std::string& name, const std::string& str);
+    Workspace* graph(const std::string& name);
+
+    // listen on a socket path & serve until stopped
+    bool start(const std::string& path);
+    void stop();
+    bool running() const {return listen_fd_ >= 0;}
+
+    // queue a request & block for its reply; used by connections
+    std::string request(const std::string& str);
+
+    uint64_t requests() const {return requests_;}
+    uint64_t runs() const {return runs_;}
+    uint64_t batches() const {return batches_;}
+    // connection threads not yet reaped; finished ones are joined on the
+    // next accept
+    size_t connections() const
+    {
+      std::lock_guard<std::mutex> lock(conns_mutex_);
+      return conns_.size();
+    }
+
+    // uvw_server <socket path> <name>=<workspace json file>...; serves
+    // until SIGINT/SIGTERM. proc types must be registered beforehand
+    static int main(int argc, char** argv);
+  };
+};
+
+// implementation
+#include <csignal>
+#include <fstream>
+#include <sstream>
+
+inline bool uvw::Server::load(const std::string& name, const std::string& str)
+{
+  if (running() || name.empty() || graphs_.count(name))
+  {
+    return false;
+  }
+  std::unique_ptr<Workspace> ws(new Workspace());
+  if (!ws->from_str(str) || !ws->process(true))
+  {
+    std::cerr << "Failure: cannot load graph '" << name << "'!" << std::endl;
+    ws->clear();
+    return false;
+  }
+  graphs_[name] = std::move(ws);
+  return true;
+}
+
+inline uvw::Workspace* uvw::Server::graph(const std::string& name)
+{
+  auto itr = graphs_.find(name);
+  return (itr == graphs_.end())? nullptr : itr->second.get();
+}
+
+inline bool uvw::Server::start(const std::string& path)
+{
+  if (running())
+  {
+    return false;
+  }
+  unlink(path.c_str());
+  listen_fd_ = SocketTransport::listen(path, 128);
+  if (listen_fd_ < 0)
+  {
+    std::cerr << "Cannot listen on '" << path << "'!" << std::endl;
+    return false;
+  }
+  path_ = path;
+  stopping_ = false;
+  executor_ = std::thread(&Server::execute_, this);
+  acceptor_ = std::thread(&Server::accept_, this);
+  return true;
+}
+
+inline void uvw::Server::stop()
+{
+  if (!running())
+  {
+    return;
+  }
+  // wake the acceptor & connections blocked on their sockets
+  shutdown(listen_fd_, SHUT_RDWR);
+  acceptor_.join();
+  {
+    std::lock_guard<std::mutex> lock(conns_mutex_);
+    for (int fd : conn_fds_)
+    {
+      shutdown(fd, SHUT_RDWR);
+    }
+  }
+  for (auto& conn : conns_)
+  {
+    conn.join();
+  }
+  conns_.clear();
+  conn_fds_.clear();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  executor_.join();
+
+  ::close(listen_fd_);
+  listen_fd_ = -1;
+  unlink(path_.c_str());
+  path_.clear();
+}
+
+inline void uvw::Server::accept_()
+{
+  while (true)
+  {
+    int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> lock(conns_mutex_);
+    for (size_t i = 0; i < conns_.size();)
+    {
+      if (conn_fds_[i] >= 0)
+      {
+        i++;
+        continue;
+      }
+      conns_[i].join();
+      conns_[i] = std::move(conns_.back());
+      conn_fds_[i] = conn_fds_.back();
+      conns_.pop_back();
+      conn_fds_.pop_back();
+    }
+    conn_fds_.push_back(fd);
+    conns_.emplace_back(&Server::serve_, this, fd);
+  }
+}
+
+inline void uvw::Server::serve_(int fd)
+{
+  SocketTransport t(fd);
+  std::vector<char> msg;
+  while (t.recv(msg))
+  {
+    std::string reply = request(std::string(msg.begin(), msg.end()));
+    if (!t.send(std::vector<char>(reply.begin(), reply.end())))
+    {
+      break;
+    }
+  }
+  // the thread is reaped on the next accept or on stop
+  std::lock_guard<std::mutex> lock(conns_mutex_);
+  for (auto& conn_fd : conn_fds_)
+  {
+    if (conn_fd == fd)
+    {
+      conn_fd = -1;
+    }
+  }
+}
+
+inline std::string uvw::Server::request(const std::string& str)
+{
+  // parsed on the calling thread
+  Request req;
+  std::string err = picojson::parse(req.data, str);
+  if (!err.empty() || !req.data.is<json::object>())
+  {
+    return "{\"ok\":false,\"error\":\"invalid request\"}";
+  }
+  auto& data_obj = req.data.get<json::object>();
+  if (data_obj.count("stats"))
+  {
+    json::object res;
+    res["ok"] = json(true);
+    res["requests"] = json((int64_t)requests_.load());
+    res["runs"] = json((int64_t)runs_.load());
+    res["batches"] = json((int64_t)batches_.load());
+    return json(res).serialize();
+  }
+  auto flag = [&data_obj](const std::string& key)
+  {
+    return data_obj.count(key) && data_obj[key].is<bool>() &&
+      data_obj[key].get<bool>();
+  };
+  req.key = data_obj.count("vars")? data_obj["vars"].serialize() : "";
+  req.key += flag("preprocess")? "*" : (flag("run")? "+" : "-");
+
+  auto reply = req.reply.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+    {
+      return "{\"ok\":false,\"error\":\"stopped\"}";
+    }
+    queue_.push_back(&req);
+  }
+  cv_.notify_one();
+  return reply.get();
+}
+
+inline void uvw::Server::execute_()
+{
+  std::deque<Request*> batch;
+  // last key run per graph within a batch
+  std::map<Workspace*, std::pair<std::string, bool> > last;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this](){return stopping_ || queue_.size();});
+      if (queue_.empty())
+      {
+        return;
+      }
+      batch.swap(queue_);
+    }
+    batches_++;
+    last.clear();
+
+    for (auto* req : batch)
+    {
+      auto& data_obj = req->data.get<json::object>();
+      Workspace* ws = data_obj.count("graph") &&
+        data_obj["graph"].is<std::string>()?
+          graph(data_obj["graph"].get<std::string>()) : nullptr;
+      if (!ws)
+      {
+        req->reply.set_value("{\"ok\":false,\"error\":\"unknown graph\"}");
+        continue;
+      }
+      requests_++;
+
+      auto itr = last.find(ws);
+      bool ok;
+      // malformed vars (mistyped json) throw from the json accessors
+      try
+      {
+        if (itr != last.end() && itr->second.first == req->key)
+        {
+          // coalesced into the previous run of the same graph
+          ok = itr->second.second;
+        }
+        else
+        {
+          ok = ws->apply_delta(req->data);
+          if (ok && req->key.back() != '-')
+          {
+            ok = ws->process(req->key.back() == '*');
+            runs_++;
+          }
+          last[ws] = {req->key, ok};
+        }
+        req->reply.set_value(reply_(*ws, req->data, ok));
+      }
+      catch (const std::exception&)
+      {
+        // vars may be partially applied
+        last.erase(ws);
+        req->reply.set_value("{\"ok\":false,\"error\":\"invalid request\"}");
+      }
+    }
+    batch.clear();
+  }
+}
+
+inline std::string uvw::Server::reply_(Workspace& ws, json& data, bool ok)
+{
+  json::object res;
+  json::array values;
+  auto& data_obj = data.get<json::object>();
+  if (ok && data_obj.count("get") && data_obj["get"].is<json::array>())
+  {
+    for (auto& itr : data_obj["get"].get<json::array>())
+    {
+      if (!itr.is<json::object>())
+      {
+        ok = false;
+        break;
+      }
+      auto& var_obj = itr.get<json::object>();
+      int64_t index = var_obj["index"].is<int64_t>()?
+        var_obj["index"].get<int64_t>() : -1;
+      Variable* v = (index >= 0 && index < (int64_t)ws.proc_ptrs().size() &&
+        var_obj["label"].is<std::string>())?
+          ws.proc_ptrs()[index]->get(var_obj["label"].get<std::string>()) :
+          nullptr;
+      if (!v)
+      {
+        ok = false;
+        break;
+      }
+      values.push_back(v->to_json().get<json::object>()["value"]);
+    }
+  }
+  res["ok"] = json(ok);
+  if (ok)
+  {
+    res["values"] = json(values);
+  }
+  return json(res).serialize();
+}
+
+inline int uvw::Server::main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cerr << "usage: " << argv[0] <<
+      " <socket path> <name>=<workspace json file>..." << std::endl;
+    return 1;
+  }
+  Server server;
+  for (int i = 2; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    size_t eq = arg.find('=');
+    std::ifstream file(eq == std::string::npos? "" : arg.substr(eq + 1));
+    std::stringstream ss;
+    ss << file.rdbuf();
+    if (!file || !server.load(arg.substr(0, eq), ss.str()))
+    {
+      std::cerr << "Cannot load '" << arg << "'!" << std::endl;
+      return 1;
+    }
+  }
+
+  // handle termination signals synchronously
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  if (!server.start(argv[1]))
+  {
+    return 1;
+  }
+  std::cout << "Serving " << argc - 2 << " graph(s) on " << argv[1] <<
+    std::endl;
+  int sig;
+  sigwait(&signals, &sig);
+  server.stop();
+  std::cout << "Served " << server.requests() << " requests in " <<
+    server.runs() << " runs." << std::endl;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,357 @@
+#ifndef UVW_SHARED_H
+#define UVW_SHARED_H
+
+#include "variable.h"
+#include "processor.h"
+#include "workspace.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+
+namespace uvw
+{
+  // POSIX shared-memory segment of named slots sharing var values across
+  // processes; writers bind vars to slots, readers link vars to slots.
+  // values are published by a seqlocked store once their proc is
+  // processed; reads fail after Variable::seq_retries retries, so a writer
+  // dying mid-store cannot stall readers
+  class SharedStore
+  {
+    public:
+
+    static const uint32_t max_slots = 256;
+    static const size_t name_size = 64;
+
+    struct Slot
+    {
+      char name[name_size];
+      uint64_t offset;
+      uint64_t size;
+      std::atomic<uint64_t> seq;
+    };
+
+    struct Header
+    {
+      uint64_t magic;
+      uint64_t size;
+      // pid of the process holding the header, 0 if free
+      std::atomic<int32_t> lock;
+      uint32_t n_slots;
+      uint64_t used;
+      Slot slots[max_slots];
+    };
+
+    protected:
+
+    std::string name_;
+    Header* header_;
+    size_t size_;
+    bool owner_;
+
+    // vars bound/linked through this store, restored on close
+    std::vector<Duohash> bound_;
+
+    // take the header lock, over from dead holders; fails after
+    // Variable::seq_retries retries
+    bool lock_();
+    void unlock_();
+    Slot* find_(const std::string& slot);
+    Slot* scan_(const std::string& slot);
+    Slot* alloc_(const std::string& slot, size_t size);
+    char* data_(Slot* slot) {return ((char*)header_) + slot->offset;}
+
+    public:
+
+    SharedStore(): header_(nullptr), size_(0), owner_(false) {}
+    ~SharedStore() {close();}
+    SharedStore(const SharedStore&) = delete;
+    SharedStore& operator=(const SharedStore&) = delete;
+
+    // create (size > 0) or attach to (size == 0) a named segment
+    bool open(const std::string& name, size_t size = 0);
+    void close();
+    static bool remove(const std::string& name);
+    bool is_open() const {return header_ != nullptr;}
+
+    // writer: publish the var value to a slot, now & once its proc is
+    // processed (see Workspace::process)
+    template<typename T> bool bind(Var<T>& v, const std::string& slot);
+    // reader: link var to a slot; pulls are version-checked
+    template<typename T> bool link(Var<T>& v, const std::string& slot);
+
+    // consistent copy of a slot's value; value is kept on failure
+    template<typename T> bool read(const std::string& slot, T& value);
+    uint64_t version(const std::string& slot);
+  };
+};
+
+// implementation
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+template<typename T>
+bool uvw::SharedStore::bind(Var<T>& v, const std::string& slot)
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+    "shared vars must be trivially copyable");
+  Slot* s = alloc_(slot, sizeof(T));
+  if (!s || v.key_.is_null())
+  {
+    return false;
+  }
+  v.data_seq_ = &s->seq;
+  v.data_pub_ = data_(s);
+  v.publish_();
+  if (v.proc())
+  {
+    v.proc()->shared_ = true;
+  }
+  bound_.push_back(v.key_);
+  return true;
+}
+
+template<typename T>
+bool uvw::SharedStore::link(Var<T>& v, const std::string& slot)
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+    "shared vars must be trivially copyable");
+  Slot* s = find_(slot);
+  if (!s || s->size != sizeof(T) || v.key_.is_null())
+  {
+    return false;
+  }
+  v.unlink();
+  v.data_src_ = data_(s);
+  v.data_seq_ = &s->seq;
+  bound_.push_back(v.key_);
+  return true;
+}
+
+template<typename T>
+bool uvw::SharedStore::read(const std::string& slot, T& value)
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+    "shared vars must be trivially copyable");
+  Slot* s = find_(slot);
+  if (!s || s->size != sizeof(T))
+  {
+    return false;
+  }
+  alignas(T) char buf[sizeof(T)];
+  if (!uvw::Variable::read_seq_(buf, data_(s), sizeof(T), s->seq))
+  {
+    return false;
+  }
+  std::memcpy((void*)&value, buf, sizeof(T));
+  return true;
+}
+
+inline bool uvw::SharedStore::open(const std::string& name, size_t size)
+{
+  close();
+  bool create = (size > 0);
+  int fd = shm_open(name.c_str(), create? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR,
+    0600);
+  if (fd < 0)
+  {
+    std::cerr << "Cannot open shared store '" << name << "'!" << std::endl;
+    return false;
+  }
+
+  if (create)
+  {
+    size += sizeof(Header);
+    if (ftruncate(fd, size) != 0)
+    {
+      ::close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+  }
+  else
+  {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header))
+    {
+      ::close(fd);
+      return false;
+    }
+    size = st.st_size;
+  }
+
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    if (create)
+    {
+      shm_unlink(name.c_str());
+    }
+    return false;
+  }
+
+  header_ = (Header*)ptr;
+  size_ = size;
+  name_ = name;
+  owner_ = create;
+  if (create)
+  {
+    // fresh segments are zero-filled
+    header_->magic = 0x5556575348524544ULL;
+    header_->size = size;
+    header_->lock.store(0);
+    header_->n_slots = 0;
+    header_->used = (sizeof(Header) + 63) & ~(uint64_t)63;
+  }
+  else if (header_->magic != 0x5556575348524544ULL)
+  {
+    std::cerr << "Invalid shared store '" << name << "'!" << std::endl;
+    close();
+    return false;
+  }
+  return true;
+}
+
+inline void uvw::SharedStore::close()
+{
+  if (!header_)
+  {
+    return;
+  }
+  // stop publishing bound vars & detach linked ones
+  for (const auto& key : bound_)
+  {
+    uvw::Variable* v = uvw::Workspace::get(key);
+    if (!v || !v->data_seq_)
+    {
+      continue;
+    }
+    if (v->data_pub_)
+    {
+      v->data_pub_ = nullptr;
+    }
+    else
+    {
+      v->data_src_ = nullptr;
+    }
+    v->data_seq_ = nullptr;
+  }
+  bound_.clear();
+
+  munmap(header_, size_);
+  header_ = nullptr;
+  size_ = 0;
+  owner_ = false;
+  name_.clear();
+}
+
+inline bool uvw::SharedStore::remove(const std::string& name)
+{
+  return (shm_unlink(name.c_str()) == 0);
+}
+
+inline bool uvw::SharedStore::lock_()
+{
+  int32_t pid = getpid();
+  for (uint32_t k = 0; k <= uvw::Variable::seq_retries; k++)
+  {
+    int32_t holder = 0;
+    if (header_->lock.compare_exchange_weak(holder, pid,
+      std::memory_order_acquire))
+    {
+      return true;
+    }
+    // take over from a dead holder; slots are counted once filled, so it
+    // left at most an uncounted slot
+    if (holder && kill(holder, 0) != 0 && errno == ESRCH &&
+      header_->lock.compare_exchange_strong(holder, pid,
+        std::memory_order_acquire))
+    {
+      return true;
+    }
+    if (k >= 64)
+    {
+      std::this_thread::yield();
+    }
+  }
+  std::cerr << "Cannot lock shared store '" << name_ << "'!" << std::endl;
+  return false;
+}
+
+inline void uvw::SharedStore::unlock_()
+{
+  header_->lock.store(0, std::memory_order_release);
+}
+
+inline uvw::SharedStore::Slot* uvw::SharedStore::find_(const std::string& slot)
+{
+  if (!header_ || !lock_())
+  {
+    return nullptr;
+  }
+  Slot* res = scan_(slot);
+  unlock_();
+  return res;
+}
+
+inline uvw::SharedStore::Slot* uvw::SharedStore::scan_(const std::string& slot)
+{
+  // header lock must be held
+  for (uint32_t i = 0; i < header_->n_slots; i++)
+  {
+    if (slot == header_->slots[i].name)
+    {
+      return &header_->slots[i];
+    }
+  }
+  return nullptr;
+}
+
+inline uvw::SharedStore::Slot* uvw::SharedStore::alloc_(
+  const std::string& slot,
+  size_t size
+)
+{
+  if (!header_ || slot.empty() || slot.size() >= name_size || !lock_())
+  {
+    return nullptr;
+  }
+  Slot* res = scan_(slot);
+  if (res)
+  {
+    unlock_();
+    return (res->size == size)? res : nullptr;
+  }
+
+  // cache-line aligned payloads to avoid false sharing
+  uint64_t offset = header_->used;
+  uint64_t used = (offset + size + 63) & ~(uint64_t)63;
+  if (header_->n_slots < max_slots && used <= header_->size)
+  {
+    res = &header_->slots[header_->n_slots];
+    std::strncpy(res->name, slot.c_str(), name_size);
+    res->offset = offset;
+    res->size = size;
+    res->seq.store(0);
+    header_->used = used;
+    header_->n_slots++;
+  }
+  unlock_();
+  return res;
+}
+
+inline uint64_t uvw::SharedStore::version(const std::string& slot)
+{
+  Slot* s = find_(slot);
+  return s? s->seq.load(std::memory_order_acquire) : 0;
+}
+
+#endif
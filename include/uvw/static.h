@@ -0,0 +1,313 @@
+#ifndef UVW_STATIC_H
+#define UVW_STATIC_H
+
+#include "duohash.h"
+#include "variable.h"
+#include "processor.h"
+#include "workspace.h"
+
+#include <array>
+#include <tuple>
+#include <utility>
+
+
+namespace uvw
+{
+  // link from a var member of the S-th proc to one of the D-th proc
+  template<
+    size_t S, typename SM, SM SrcMember,
+    size_t D, typename DM, DM DstMember
+  >
+  struct Link
+  {
+    static constexpr size_t src = S;
+    static constexpr size_t dst = D;
+    static constexpr SM src_member = SrcMember;
+    static constexpr DM dst_member = DstMember;
+  };
+
+  #define UVW_LINK(s, src_member, d, dst_member) \
+    uvw::Link<s, decltype(src_member), src_member,\
+      d, decltype(dst_member), dst_member>
+
+  template<typename... P> struct Procs {};
+  template<typename... L> struct Links {};
+
+  namespace static_
+  {
+    template<size_t N>
+    struct Order
+    {
+      size_t idx[N > 0? N : 1];
+      bool valid;
+    };
+
+    // Kahn's algorithm over link (src, dst) proc indices; ties are broken
+    // by proc index; out-of-range entries are ignored
+    template<size_t N, size_t M>
+    constexpr Order<N> topo_order(
+      const size_t (&srcs)[M],
+      const size_t (&dsts)[M]
+    )
+    {
+      Order<N> res{};
+      bool done[N > 0? N : 1] = {};
+      res.valid = true;
+      for (size_t k = 0; k < N; k++)
+      {
+        size_t next = N;
+        for (size_t i = 0; i < N && next == N; i++)
+        {
+          bool ready = !done[i];
+          for (size_t j = 0; j < M && ready; j++)
+          {
+            if (dsts[j] == i && srcs[j] < N && srcs[j] != i && !done[srcs[j]])
+            {
+              ready = false;
+            }
+          }
+          if (ready)
+          {
+            next = i;
+          }
+        }
+        if (next == N)
+        {
+          res.valid = false;
+          return res;
+        }
+        done[next] = true;
+        res.idx[k] = next;
+      }
+      return res;
+    }
+  };
+
+  template<typename ProcList, typename LinkList = Links<> >
+  class StaticGraph;
+
+  // fixed graph of procs held by value & processed in a compile-time
+  // topological order, with inlined pulls and non-virtual process calls
+  template<typename... P, typename... L>
+  class StaticGraph<Procs<P...>, Links<L...> >
+  {
+    public:
+
+    static constexpr size_t size = sizeof...(P);
+
+    protected:
+
+    std::tuple<P...> procs_;
+    std::array<std::string, size> types_;
+    bool valid_;
+
+    static constexpr size_t srcs_[] = {L::src..., size};
+    static constexpr size_t dsts_[] = {L::dst..., size};
+    static constexpr static_::Order<size> order_ =
+      static_::topo_order<size>(srcs_, dsts_);
+    static_assert(order_.valid, "Static graph links must be acyclic.");
+
+    template<typename T>
+    static void copy_(Var<T>& dst, Var<T>& src)
+    {
+      *((T*)dst.raw_data()) = *((T*)src.raw_data());
+    }
+
+    template<typename Lk, size_t K>
+    void pull_()
+    {
+      if (Lk::dst == K)
+      {
+        copy_(
+          std::get<Lk::dst>(procs_).*Lk::dst_member,
+          std::get<Lk::src>(procs_).*Lk::src_member
+        );
+      }
+    }
+
+    template<size_t K>
+    bool step_(bool preprocess)
+    {
+      using Proc = typename std::tuple_element<K, std::tuple<P...> >::type;
+      int pulls[] = {0, (pull_<L, K>(), 0)...};
+      (void)pulls;
+      auto& proc = std::get<K>(procs_);
+      return (!preprocess || proc.Proc::preprocess()) &&
+        proc.Proc::process(preprocess);
+    }
+
+    template<size_t... I>
+    bool run_(bool preprocess, std::index_sequence<I...>)
+    {
+      bool res = true;
+      int steps[] = {0, (res = res && step_<order_.idx[I]>(preprocess), 0)...};
+      (void)steps;
+      return res;
+    }
+
+    template<size_t... I>
+    bool init_(std::index_sequence<I...>)
+    {
+      bool res = true;
+      int inits[] = {0, (res = std::get<I>(procs_).initialize() && res, 0)...};
+      (void)inits;
+      return res;
+    }
+
+    template<size_t... I>
+    std::array<Processor*, size> proc_ptrs_(std::index_sequence<I...>)
+    {
+      return {{static_cast<Processor*>(&std::get<I>(procs_))...}};
+    }
+
+    template<typename Lk>
+    bool link_(Workspace& ws)
+    {
+      auto& src = std::get<Lk::src>(procs_).*Lk::src_member;
+      auto& dst = std::get<Lk::dst>(procs_).*Lk::dst_member;
+      return ws.link(
+        Duohash(ws.proc_ptrs()[Lk::src], src.key().var_str),
+        Duohash(ws.proc_ptrs()[Lk::dst], dst.key().var_str)
+      );
+    }
+
+    public:
+
+    // proc type strs are only needed for workspace/json conversions
+    StaticGraph(const std::array<std::string, size>& types = {}):
+      types_(types)
+    {
+      valid_ = init_(std::index_sequence_for<P...>());
+    }
+    ~StaticGraph()
+    {
+      // de-register vars before the var members are destroyed
+      for (auto* proc_ptr : proc_ptrs())
+      {
+        for (const auto& key : proc_ptr->var_keys())
+        {
+          Workspace::del(key);
+        }
+      }
+    }
+    StaticGraph(const StaticGraph&) = delete;
+    StaticGraph& operator=(const StaticGraph&) = delete;
+
+    bool valid() const {return valid_;}
+    static constexpr size_t order(size_t k) {return order_.idx[k];}
+    template<size_t I>
+    typename std::tuple_element<I, std::tuple<P...> >::type& proc()
+    {
+      return std::get<I>(procs_);
+    }
+    std::array<Processor*, size> proc_ptrs()
+    {
+      return proc_ptrs_(std::index_sequence_for<P...>());
+    }
+
+    bool process(bool preprocess = false)
+    {
+      return run_(preprocess, std::index_sequence_for<P...>());
+    }
+
+    // dynamic workspace conversions, matching procs by index
+    bool to_workspace(Workspace& ws);
+    bool from_workspace(Workspace& ws);
+    json to_json();
+    bool from_json(json& data);
+  };
+
+  template<typename... P, typename... L>
+  constexpr size_t StaticGraph<Procs<P...>, Links<L...> >::srcs_[];
+  template<typename... P, typename... L>
+  constexpr size_t StaticGraph<Procs<P...>, Links<L...> >::dsts_[];
+  template<typename... P, typename... L>
+  constexpr static_::Order<StaticGraph<Procs<P...>, Links<L...> >::size>
+    StaticGraph<Procs<P...>, Links<L...> >::order_;
+};
+
+// implementation
+
+template<typename... P, typename... L>
+bool uvw::StaticGraph<uvw::Procs<P...>, uvw::Links<L...> >::to_workspace(
+  uvw::Workspace& ws
+)
+{
+  ws.clear();
+  auto src_ptrs = proc_ptrs();
+  for (size_t i = 0; i < size; i++)
+  {
+    auto* proc_ptr = ws.new_proc(types_[i]);
+    if (!proc_ptr)
+    {
+      std::cerr << "Cannot create proc type '" <<
+        types_[i] << "'!" << std::endl;
+      return false;
+    }
+    for (auto* v : src_ptrs[i]->var_ptrs())
+    {
+      auto* u = proc_ptr->get(v->label());
+      if (!u || !u->assign(v))
+      {
+        std::cerr << "Cannot copy var '" << v->label() << "'!" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  bool res = true;
+  int links[] = {0, (res = res && link_<L>(ws), 0)...};
+  (void)links;
+  return res;
+}
+
+template<typename... P, typename... L>
+bool uvw::StaticGraph<uvw::Procs<P...>, uvw::Links<L...> >::from_workspace(
+  uvw::Workspace& ws
+)
+{
+  if (ws.proc_ptrs().size() != size)
+  {
+    std::cerr << "Mismatched proc count!" << std::endl;
+    return false;
+  }
+  auto dst_ptrs = proc_ptrs();
+  for (size_t i = 0; i < size; i++)
+  {
+    auto* proc_ptr = ws.proc_ptrs()[i];
+    if (!types_[i].empty() && types_[i] != proc_ptr->type_str())
+    {
+      std::cerr << "Mismatched proc type '" <<
+        proc_ptr->type_str() << "'!" << std::endl;
+      return false;
+    }
+    for (auto* v : dst_ptrs[i]->var_ptrs())
+    {
+      auto* u = proc_ptr->get(v->label());
+      if (u && !v->assign(u))
+      {
+        std::cerr << "Cannot copy var '" << v->label() << "'!" << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template<typename... P, typename... L>
+json uvw::StaticGraph<uvw::Procs<P...>, uvw::Links<L...> >::to_json()
+{
+  uvw::Workspace ws;
+  return to_workspace(ws)? ws.to_json() : json();
+}
+
+template<typename... P, typename... L>
+bool uvw::StaticGraph<uvw::Procs<P...>, uvw::Links<L...> >::from_json(
+  json& data
+)
+{
+  uvw::Workspace ws;
+  return ws.from_json(data) && from_workspace(ws);
+}
+
+#endif
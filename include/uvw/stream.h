@@ -0,0 +1,274 @@
+#ifndef UVW_STREAM_H
+#define UVW_STREAM_H
+
+#include "variable.h"
+#include "workspace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+
+namespace uvw
+{
+  // single-producer single-consumer lock-free ring of values. each side
+  // accesses a contiguous span of slots in place & publishes it at once;
+  // the counter of the other side is re-read only when the last seen one
+  // limits the span
+  template<typename T>
+  class Ring
+  {
+    protected:
+
+    std::vector<T> buf_;
+    size_t mask_;
+    // producer: write count & the read count last seen
+    std::atomic<size_t> head_;
+    size_t tail_seen_;
+    char pad_[64];
+    // consumer: read count & the write count last seen
+    std::atomic<size_t> tail_;
+    size_t head_seen_;
+
+    public:
+
+    // capacity is rounded up to a power of 2
+    explicit Ring(size_t capacity):
+      head_(0), tail_seen_(0), tail_(0), head_seen_(0)
+    {
+      size_t n = 2;
+      while (n < capacity)
+      {
+        n <<= 1;
+      }
+      buf_.resize(n);
+      mask_ = n - 1;
+    }
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    size_t capacity() const {return mask_ + 1;}
+    // exact on either side while the other one is idle
+    size_t size() const
+    {
+      size_t tail = tail_.load(std::memory_order_acquire);
+      return head_.load(std::memory_order_acquire) - tail;
+    }
+    bool empty() const {return size() == 0;}
+
+    // producer: free slots from ptr on; commit publishes the first n
+    size_t write_span(T*& ptr)
+    {
+      size_t head = head_.load(std::memory_order_relaxed);
+      size_t i = head & mask_;
+      size_t n = capacity() - i;
+      if (capacity() - (head - tail_seen_) < n)
+      {
+        tail_seen_ = tail_.load(std::memory_order_acquire);
+      }
+      ptr = &buf_[i];
+      return std::min(capacity() - (head - tail_seen_), n);
+    }
+    void commit(size_t n)
+    {
+      head_.store(head_.load(std::memory_order_relaxed) + n,
+        std::memory_order_release);
+    }
+
+    // consumer: queued values from ptr on; consume frees the first n
+    size_t read_span(T*& ptr)
+    {
+      size_t tail = tail_.load(std::memory_order_relaxed);
+      size_t i = tail & mask_;
+      size_t n = capacity() - i;
+      if (head_seen_ - tail < n)
+      {
+        head_seen_ = head_.load(std::memory_order_acquire);
+      }
+      ptr = &buf_[i];
+      return std::min(head_seen_ - tail, n);
+    }
+    void consume(size_t n)
+    {
+      tail_.store(tail_.load(std::memory_order_relaxed) + n,
+        std::memory_order_release);
+    }
+
+    bool push(const T& val)
+    {
+      T* ptr;
+      if (!write_span(ptr))
+      {
+        return false;
+      }
+      *ptr = val;
+      commit(1);
+      return true;
+    }
+
+    bool pop(T& val)
+    {
+      T* ptr;
+      if (!read_span(ptr))
+      {
+        return false;
+      }
+      val = std::move(*ptr);
+      consume(1);
+      return true;
+    }
+  };
+
+  // processing of a workspace seq per sample: each value is written to the
+  // input var (see Workspace::set_input), the seq processed as by
+  // Workspace::process (pruned & fused alike) & the output var read (see
+  // Workspace::set_output). the workspace lock, var lookups & the pruning
+  // plan are taken once per run, so the per-sample cost is the seq itself.
+  // lazy evaluation is not supported while streaming
+  template<typename I, typename O = I>
+  class Stream
+  {
+    protected:
+
+    Workspace& ws_;
+    Duohash in_key_, out_key_;
+    Var<I>* in_;
+    Var<O>* out_;
+    Workspace::Stamp stamp_;
+    bool pruning_;
+    bool failed_;
+
+    // resolve the input & output vars; fails if unset or mistyped
+    bool bind_();
+    bool step_(const I& val, O& res)
+    {
+      in_->set(val);
+      if (!ws_.run_seq_(false, pruning_))
+      {
+        failed_ = true;
+        return false;
+      }
+      res = out_->ref();
+      return true;
+    }
+
+    public:
+
+    explicit Stream(Workspace& ws):
+      ws_(ws), in_(nullptr), out_(nullptr), pruning_(false),
+      failed_(false), batch(256) {}
+
+    // samples per span published to the rings
+    size_t batch;
+
+    // process the samples of [first, last) into out; returns the samples
+    // processed, up to a failure (see failed)
+    template<class InIt, class OutIt>
+    size_t run(InIt first, InIt last, OutIt out);
+
+    // process samples queued in in into out, until in is empty, out is
+    // full (remaining samples stay queued) or max samples are processed;
+    // returns the samples processed, up to a failure. the failing sample
+    // is left queued
+    size_t pump(Ring<I>& in, Ring<O>& out, size_t max = (size_t)-1);
+
+    // whether the last run or pump stopped at a failure
+    bool failed() const {return failed_;}
+  };
+};
+
+// implementation
+
+template<typename I, typename O>
+bool uvw::Stream<I, O>::bind_()
+{
+  failed_ = false;
+  if (in_ && out_ && in_key_ == ws_.in_ && out_key_ == ws_.out_ &&
+    stamp_.valid())
+  {
+    pruning_ = ws_.update_prune_();
+    return true;
+  }
+
+  in_ = nullptr;
+  out_ = nullptr;
+  auto* in = ws_.in_.is_null()? nullptr : uvw::Workspace::get(ws_.in_);
+  auto* out = ws_.out_.is_null()? nullptr : uvw::Workspace::get(ws_.out_);
+  if (!in || !out || !in->is_of_type<I>() || !out->is_of_type<O>() ||
+    ws_.seq_.empty())
+  {
+    std::cout << "Failure: stream input/output vars unset or mistyped." <<
+      std::endl;
+    failed_ = true;
+    return false;
+  }
+  in_ = static_cast<Var<I>*>(in);
+  out_ = static_cast<Var<O>*>(out);
+  in_key_ = ws_.in_;
+  out_key_ = ws_.out_;
+  stamp_.make(ws_.proc_ptrs_);
+  pruning_ = ws_.update_prune_();
+  return true;
+}
+
+template<typename I, typename O>
+template<class InIt, class OutIt>
+size_t uvw::Stream<I, O>::run(InIt first, InIt last, OutIt out)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  if (!bind_())
+  {
+    return 0;
+  }
+  size_t n = 0;
+  O res;
+  for (; first != last && step_(*first, res); ++first, ++out)
+  {
+    *out = res;
+    n++;
+  }
+  return n;
+}
+
+template<typename I, typename O>
+size_t uvw::Stream<I, O>::pump(Ring<I>& in, Ring<O>& out, size_t max)
+{
+  std::lock_guard<std::recursive_mutex> lock(uvw::Workspace::mutex_);
+  if (!bind_())
+  {
+    return 0;
+  }
+  size_t done = 0;
+  while (done < max)
+  {
+    I* src = nullptr;
+    O* dst = nullptr;
+    size_t n = in.read_span(src);
+    if (n != 0)
+    {
+      n = std::min(n, out.write_span(dst));
+    }
+    n = std::min(n, std::min(max - done, std::max<size_t>(batch, 1)));
+    if (n == 0)
+    {
+      break;
+    }
+    size_t i = 0;
+    while (i < n && step_(src[i], dst[i]))
+    {
+      i++;
+    }
+    out.commit(i);
+    in.consume(i);
+    done += i;
+    if (i < n)
+    {
+      break;
+    }
+  }
+  return done;
+}
+
+#endif
@@ -6,6 +6,13 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <typeindex>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <type_traits>
 
 #include <picojson.h>
 using json = picojson::value;
@@ -15,37 +22,135 @@ namespace uvw
 {
   class Workspace;
   class Processor;
+  class SharedStore;
+  class Builder;
+  class Variable;
+
+  // binary state codec for var types that are not trivially copyable;
+  // load returns the number of bytes consumed, or 0 on failure
+  struct StateCodec
+  {
+    std::function<void(const void*, std::vector<char>&)> save;
+    std::function<size_t(void*, const char*, size_t)> load;
+  };
+
+  // elementwise kernel of a fusible proc; eval computes n elements of each
+  // output from n elements of each input. vars are either double (scalars,
+  // broadcast over batches) or std::vector<double> (batches)
+  struct Kernel
+  {
+    std::vector<Variable*> ins;
+    std::vector<Variable*> outs;
+    std::function<
+      void(const double* const* ins, double* const* outs, size_t n)
+    > eval;
+  };
+
+  // value conversions & state copies of Var<T>; specialize for value types
+  // picojson cannot represent or that share data between copies (see Array)
+  template<class T>
+  struct ValueTraits
+  {
+    static json to_json(const T& val) {return json(val);}
+    // val is written only if data holds a valid value
+    static bool from_json(const json& data, T& val)
+    {
+      if (!data.is<T>())
+      {
+        return false;
+      }
+      val = data.get<T>();
+      return true;
+    }
+    static void copy(T& dst, const T& src) {dst = src;}
+  };
 
   class Variable
   {
     friend class Workspace;
+    friend class Builder;
     friend class Processor;
+    friend class SharedStore;
+    friend class Parallel;
 
     protected:
 
     Duohash key_;
     Duohash src_;
+    Variable* src_var_;
     void* data_ptr_;
+    // data of the chain head; kept resolved under the registry lock as
+    // links & head storage change (see reroot_), so reads never write
     void* data_src_;
+    Variable* root_;
+    // walk marks of reroot_
+    uint64_t mark_;
+    static uint64_t marks_;
+    // version counter guarding shared data, & the shared slot values are
+    // published to after processing (see SharedStore)
+    std::atomic<uint64_t>* data_seq_;
+    void* data_pub_;
+    // bumped on every enabled toggle; see Workspace pruning
+    static std::atomic<uint64_t> enabled_epoch_;
+    bool enabled_;
+    // handed out by ref() outside of processing under lazy evaluation;
+    // see hold
+    bool held_;
+    // fields flagged for the next Workspace::to_delta, & whether the var is
+    // listed there; see mark_delta
+    uint8_t delta_;
+    static const uint8_t delta_listed_ = 0x80;
 
     public:
 
     static bool data_pull;
+    static bool data_lazy;
+    // retries of reads of shared data before failing, e.g. if the writer
+    // died mid-write (see SharedStore)
+    static uint32_t seq_retries;
 
-    bool enabled;
     std::unordered_map<std::string, int> properties;
 
+    // procs contributing to disabled vars only are skipped by processing
+    // (see Workspace::pruned)
+    bool enabled() const {return enabled_;}
+    void set_enabled(bool on)
+    {
+      if (enabled_ != on)
+      {
+        enabled_ = on;
+        enabled_epoch_++;
+        mark_delta(DELTA_ENABLED);
+      }
+    }
+
+    // fields relayed by the next Workspace::to_delta; set, set_enum,
+    // set_enabled & patch_json flag theirs, as do writes through ref() under
+    // lazy evaluation (see hold); other direct writes (e.g. to enums) are
+    // flagged by hand. writes of procs being processed are their own
+    // outputs & are not flagged
+    enum DeltaField {DELTA_VALUE = 1, DELTA_ENABLED = 2, DELTA_ENUMS = 4};
+    void mark_delta(uint8_t fields);
+
     protected:
 
     void init()
     {
       key_.nullify();
       src_.nullify();
+      src_var_ = nullptr;
+      root_ = this;
+      mark_ = 0;
       incoming_.clear();
-      enabled = true;
+      enabled_ = true;
+      held_ = false;
+      delta_ = 0;
       data_ptr_ = nullptr;
       data_src_ = nullptr;
+      data_seq_ = nullptr;
+      data_pub_ = nullptr;
       properties.clear();
+      subs_.reset();
     }
 
     public:
@@ -65,23 +170,97 @@ namespace uvw
     bool link(Variable* src);
     const Duohash& src() {return src_;}
 
-    virtual void pull() = 0;
+    // lazy evaluation; see Workspace::evaluate & Workspace::touch
+    bool evaluate();
+    void touch();
+    // keep the value as of a mutable ref handed out outside of processing;
+    // the next evaluate touches the var if it changed meanwhile, so writes
+    // through ref() are tracked like set()
+    void hold();
+    // push mode; see Workspace::push
+    bool push();
+
+    // change subscriptions: callbacks run on the processing thread once the
+    // var's proc is processed & the value differs from the one last seen
+    // (by operator==; always for types specialized by
+    // UVW_VAR_SPECIALIZE_DEFAULT). under Parallel they run on its caller
+    // once the frame is done, in seq order. values written outside of
+    // procs are seen by notify or Workspace::push; intermediates of fused
+    // runs only if materialized (see Workspace::fuse). returns an id to
+    // unsubscribe, 0 if the var is not registered to a proc
+    typedef std::function<void(Variable*)> Callback;
+    size_t subscribe(const Callback& callback);
+    bool unsubscribe(size_t id);
+    bool subscribed() const {return subs_ && subs_->n > 0;}
+    // fire the callbacks if the value changed since last seen
+    bool notify();
+
+    // copy the value from the source; fails if shared data cannot be read
+    // consistently (see seq_retries)
+    virtual bool pull() = 0;
+    // typed copy loop over n dst/src value pairs; see Workspace pull plans
+    typedef void (*CopyLoop)(void* const* dsts, const void* const* srcs,
+      size_t n);
+    virtual CopyLoop copy_loop() = 0;
     virtual const std::type_index type_index() = 0;
+    virtual size_t data_size() = 0;
+    virtual bool is_trivial() = 0;
+    // move the value into external storage (own storage if nullptr)
+    virtual void rebind(void* ptr) = 0;
 
     virtual json to_json();
     virtual bool from_json(json& data);
+    // partial from_json; only entries present in data are updated
+    virtual bool patch_json(json& data);
+
+    // copy states (but not links) from a var of the same type
+    virtual bool assign(Variable* var);
+    // copy the value only from a var of the same type
+    virtual bool copy_value(Variable* var) = 0;
 
     const std::string type_str();
     static std::map<std::type_index, std::string> type_strs;
+    static std::map<std::type_index, StateCodec> state_codecs;
 
     virtual bool set_enum(const std::string& key) = 0;
     virtual const std::string default_enum() {return "";}
     virtual const std::vector<std::string> enum_keys() {return {};}
 
     protected:
-    void propagate(void* data_src);
+    void* src_data_() const {return data_src_;}
+    // re-resolve the heads of vars & of the vars downstream of them, in
+    // time linear in those; a cyclic chain is headed by the var closing it
+    static void reroot_(const std::vector<Variable*>& vars);
+    // unlink vars at once, re-resolving their downstream vars once
+    static void unlink_(const std::vector<Variable*>& vars);
+    // bump the version of the workspace owning the var's proc (see
+    // Workspace::Stamp)
+    void bump_();
+    // storage moved; downstream vars of a head follow it
+    void moved_();
+    // seqlock copy of size bytes, retried while written
+    static bool read_seq_(void* dst, const void* src, size_t size,
+      const std::atomic<uint64_t>& seq);
+    // publish the value to the shared slot; odd versions mark the store
+    void publish_();
     std::unordered_set<Duohash> incoming_;
     template<class T> static T null_;
+
+    // subscriptions, allocated on the first; callbacks by id, nulled if
+    // unsubscribed while firing & erased after
+    struct Subs
+    {
+      std::list<std::pair<size_t, Callback> > callbacks;
+      size_t n = 0;
+      size_t id = 0;
+      bool firing = false;
+    };
+    std::unique_ptr<Subs> subs_;
+    // keep the value as last seen; true if it differs from the previous
+    virtual bool changed_() {return true;}
+    // keep the value as held; true if it differs from the one held
+    virtual void hold_() {}
+    virtual bool drifted_() {return true;}
   };
 
   template<class T>
@@ -92,36 +271,141 @@ namespace uvw
 
     protected:
 
+    // own storage; data_ptr_ may point elsewhere (e.g. shared memory)
     T value_;
+    T& data_() {return *((T*)data_ptr_);}
 
     public:
 
-    Var(): Variable() {}
+    Var(): Variable() {data_ptr_ = &value_;}
+    // copies carry states only; keys, links & storage are not shared
+    Var(const Var& v): Variable() {data_ptr_ = &value_; *this = v;}
+    Var& operator=(const Var& v)
+    {
+      if (&v != this)
+      {
+        ValueTraits<T>::copy(data_(), *((T*)v.data_ptr_));
+        values = v.values;
+        enums = v.enums;
+        set_enabled(v.enabled());
+        properties = v.properties;
+      }
+      return *this;
+    }
 
     const std::type_index type_index() override
     {
       return std::type_index(typeid(T));
     }
+    size_t data_size() override {return sizeof(T);}
+    bool is_trivial() override
+    {
+      return std::is_trivially_copyable<T>::value;
+    }
+
+    void rebind(void* ptr) override
+    {
+      T* dst = ptr? (T*)ptr : &value_;
+      if (dst != data_ptr_)
+      {
+        *dst = data_();
+        data_ptr_ = dst;
+        moved_();
+      }
+    }
+
+    bool pull() override
+    {
+      if (src_data_() == nullptr)
+      {
+        return true;
+      }
+      if (data_seq_ == nullptr)
+      {
+        data_() = *((T*)data_src_);
+        return true;
+      }
+      // shared values are trivially copyable; kept as is on failure
+      alignas(T) char buf[sizeof(T)];
+      if (!read_seq_(buf, data_src_, sizeof(T), *data_seq_))
+      {
+        return false;
+      }
+      std::memcpy((void*)data_ptr_, buf, sizeof(T));
+      return true;
+    }
 
-    void pull() override
+    static void copy_loop_(void* const* dsts, const void* const* srcs,
+      size_t n)
     {
-      if (data_src_)
+      for (size_t i = 0; i < n; i++)
       {
-        value_ = *((T*)data_src_);
+        *((T*)dsts[i]) = *((const T*)srcs[i]);
       }
     }
+    CopyLoop copy_loop() override {return &copy_loop_;}
+
+    protected:
+
+    // value as of the last hold
+    std::unique_ptr<T> held_value_;
+    void hold_() override
+    {
+      if (!held_value_)
+      {
+        held_value_.reset(new T());
+      }
+      ValueTraits<T>::copy(*held_value_, data_());
+    }
+    bool drifted_() override
+    {
+      return !held_value_ || !(*held_value_ == data_());
+    }
+
+    // value last seen by subscriptions
+    std::unique_ptr<T> seen_;
+    bool changed_() override
+    {
+      const T& val = (data_pull || src_data_() == nullptr)?
+        data_() : *((T*)data_src_);
+      if (seen_ && *seen_ == val)
+      {
+        return false;
+      }
+      if (!seen_)
+      {
+        seen_.reset(new T());
+      }
+      ValueTraits<T>::copy(*seen_, val);
+      return true;
+    }
+
+    public:
 
     // type-specific members
     std::unordered_map<std::string, T> values;
 
     T& ref()
     {
-      return (data_pull || data_src_ == nullptr)?
-        value_ : *((T*)data_src_);
+      if (data_lazy)
+      {
+        evaluate();
+        hold();
+      }
+      return (data_pull || src_data_() == nullptr)?
+        data_() : *((T*)data_src_);
     }
     T& operator()() {return ref();}
     T get() {return ref();}
-    void set(const T& val) {value_ = val;}
+    void set(const T& val)
+    {
+      data_() = val;
+      mark_delta(DELTA_VALUE);
+      if (data_lazy)
+      {
+        touch();
+      }
+    }
     const T& default_value()
     {
       return (values.find("default") != values.end()?
@@ -149,7 +433,8 @@ namespace uvw
       {
         if (itr.first == key)
         {
-          value_ = itr.second;
+          data_() = itr.second;
+          mark_delta(DELTA_VALUE);
           return true;
         }
       }
@@ -182,6 +467,29 @@ namespace uvw
       return keys;
     }
 
+    bool assign(Variable* var) override
+    {
+      if (var == this || type_index() != var->type_index())
+      {
+        return false;
+      }
+      auto* v = static_cast<Var<T>*>(var);
+      ValueTraits<T>::copy(data_(), v->data_());
+      values = v->values;
+      enums = v->enums;
+      return Variable::assign(var);
+    }
+
+    bool copy_value(Variable* var) override
+    {
+      if (var == this || type_index() != var->type_index())
+      {
+        return false;
+      }
+      ValueTraits<T>::copy(data_(), static_cast<Var<T>*>(var)->data_());
+      return true;
+    }
+
     // json serialize
 
     json to_json() override
@@ -196,7 +504,7 @@ namespace uvw
         {
           json::object elem;
           elem["key"] = json(itr.first);
-          elem["value"] = json(itr.second);
+          elem["value"] = ValueTraits<T>::to_json(itr.second);
           enum_array.push_back(json(elem));
         }
         data_obj["enums"] = json(enum_array);
@@ -207,51 +515,98 @@ namespace uvw
         json::object value_obj;
         for (auto& itr : values)
         {
-          value_obj[itr.first] = json(itr.second);
+          value_obj[itr.first] = ValueTraits<T>::to_json(itr.second);
         }
         data_obj["values"] = json(value_obj);
       }
 
-      data_obj["value"] = json(get());
+      data_obj["value"] = ValueTraits<T>::to_json(get());
 
       return data;
     }
 
     bool from_json(json& data) override
+    {
+      return patch_(data, true);
+    }
+
+    bool patch_json(json& data) override
+    {
+      return patch_(data, false);
+    }
+
+    private:
+
+    // parse all entries before updating any, so invalid data leaves the
+    // var as is; from_json resets the entries missing in data
+    bool patch_(json& data, bool reset)
     {
       auto& data_obj = data.get<json::object>();
 
-      enums.clear();
-      if (data_obj.find("enums") != data_obj.end() &&
-            data_obj["enums"].is<json::array>())
+      bool has_enums = data_obj.find("enums") != data_obj.end() &&
+        data_obj["enums"].is<json::array>();
+      std::vector<std::pair<std::string, T> > new_enums;
+      if (has_enums)
       {
         for (auto& itr : data_obj["enums"].get<json::array>())
         {
           auto enum_obj = itr.get<json::object>();
-          enums.push_back(
-            {
-              enum_obj["key"].get<std::string>(),
-              enum_obj["value"].get<T>()
-            }
-          );
+          new_enums.push_back({enum_obj["key"].get<std::string>(), T()});
+          if (!ValueTraits<T>::from_json(enum_obj["value"],
+                new_enums.back().second))
+          {
+            std::cerr << "Failure: invalid enum value!" << std::endl;
+            return false;
+          }
         }
       }
 
-      values.clear();
-      if (data_obj.find("values") != data_obj.end())
+      bool has_values = data_obj.find("values") != data_obj.end();
+      std::unordered_map<std::string, T> new_values;
+      if (has_values)
       {
         for (auto& itr : data_obj["values"].get<json::object>())
         {
-          values[itr.first] = itr.second.get<T>();
+          if (!ValueTraits<T>::from_json(itr.second, new_values[itr.first]))
+          {
+            std::cerr << "Failure: invalid value '" << itr.first << "'!" <<
+              std::endl;
+            return false;
+          }
         }
       }
 
-      if (data_obj.find("value") != data_obj.end())
+      bool has_value = data_obj.find("value") != data_obj.end();
+      T new_value;
+      if (has_value &&
+            !ValueTraits<T>::from_json(data_obj["value"], new_value))
+      {
+        std::cerr << "Failure: invalid value!" << std::endl;
+        return false;
+      }
+
+      if (reset)
+      {
+        enums.clear();
+        values.clear();
+        properties.clear();
+      }
+      if (has_enums)
+      {
+        enums.swap(new_enums);
+        mark_delta(DELTA_ENUMS);
+      }
+      if (has_values)
+      {
+        values.swap(new_values);
+      }
+      if (has_value)
       {
-        value_ = data_obj["value"].get<T>();
+        data_() = std::move(new_value);
+        mark_delta(DELTA_VALUE);
       }
 
-      return Variable::from_json(data);
+      return Variable::patch_json(data);
     }
   };
 
@@ -261,8 +616,18 @@ namespace uvw
         {return Variable::default_enum();}\
     template<> bool uvw::Var<x>::from_json(json& data)\
         {return Variable::from_json(data);}\
+    template<> bool uvw::Var<x>::patch_json(json& data)\
+        {return Variable::patch_json(data);}\
     template<> json uvw::Var<x>::to_json()\
-        {return Variable::to_json();}
+        {return Variable::to_json();}\
+    template<> bool uvw::Var<x>::assign(Variable* var)\
+        {return Variable::assign(var);}\
+    template<> bool uvw::Var<x>::changed_()\
+        {return Variable::changed_();}\
+    template<> void uvw::Var<x>::hold_()\
+        {Variable::hold_();}\
+    template<> bool uvw::Var<x>::drifted_()\
+        {return Variable::drifted_();}
 
   // impl.
 
@@ -11,31 +11,96 @@
 #include <vector>
 #include <functional>
 #include <iostream>
+#include <mutex>
 
 
 namespace uvw
 {
   class Processor;
 
+  // non-owning iterable view of a registry container; valid until the
+  // container is next modified
+  template<typename C>
+  class Range
+  {
+    const C* c_;
+    static const C empty_;
+
+    public:
+
+    Range(const C* c = nullptr): c_(c? c : &empty_) {}
+    typename C::const_iterator begin() const {return c_->begin();}
+    typename C::const_iterator end() const {return c_->end();}
+    size_t size() const {return c_->size();}
+    bool empty() const {return c_->empty();}
+  };
+  template<typename C> const C Range<C>::empty_{};
+
   class Workspace
   {
     friend class Variable;
     friend class Processor;
+    friend class Builder;
+    friend class Reload;
+    friend class Partition;
+    friend class Parallel;
+    template<typename I, typename O> friend class Stream;
 
     protected:
 
+    // guards registry changes against process() while a workspace is
+    // rebuilt on another thread (see Reload)
+    static std::recursive_mutex mutex_;
+
     static std::unordered_map<Duohash, Variable*> vars_;
     static std::unordered_map<Duohash, Duohash> links_;
 
+    // version of the procs of a workspace, shared by its procs & moved
+    // along with them by swap; bumped whenever their vars are
+    // (de)registered, re-linked or moved to other storage. procs outside
+    // of workspaces share a loose version
+    typedef std::shared_ptr<uint64_t> Version;
+    Version version_;
+    static Version loose_;
+    // versions a plan over procs was made at, one per distinct owner; a
+    // plan stays valid as long as none of them changes
+    struct Stamp
+    {
+      std::vector<std::pair<Version, uint64_t> > versions;
+      bool made = false;
+      void make(const std::vector<Processor*>& procs);
+      void reset() {versions.clear(); made = false;}
+      bool valid() const
+      {
+        for (const auto& v : versions)
+        {
+          if (*v.first != v.second)
+          {
+            return false;
+          }
+        }
+        return made;
+      }
+    };
+
+    // registry indexes by owner proc & by proc type
+    static std::unordered_map<void*,
+      std::unordered_map<Duohash, Variable*> > vars_by_procs_;
+    static std::unordered_map<std::string,
+      std::unordered_set<Processor*> > procs_by_types_;
+    static void index_var_(const Duohash& key, Variable* v);
+    static void unindex_var_(const Duohash& key);
+
     template<typename T>
     static bool add_(Var<T>& v)
     {
-      if (has(v.key()))
+      if (!vars_.emplace(v.key(), (Variable*)(&v)).second)
       {
         std::cout << "Warning: var " << v.key() << " exists!" << std::endl;
         return false;
       }
-      vars_[v.key()] = (Variable*)(&v);
+      index_var_(v.key(), (Variable*)(&v));
+      v.bump_();
       return true;
     }
 
@@ -52,8 +117,20 @@ namespace uvw
       {
         if (!key.is_null())
         {
+          // detach downstream vars from the removed storage
+          auto incoming = vars_[key]->incoming_;
+          for (const auto& dst : incoming)
+          {
+            if (has(dst))
+            {
+              vars_[dst]->unlink();
+            }
+          }
           vars_[key]->unlink();
+          vars_[key]->bump_();
         }
+        unindex_var_(key);
+        pushes_.erase(key);
         return (vars_.erase(key) > 0);
       }
       return false;
@@ -61,7 +138,8 @@ namespace uvw
 
     static Variable* get(const Duohash& key)
     {
-      return has(key)? vars_[key]:nullptr;
+      auto itr = vars_.find(key);
+      return (itr != vars_.end())? itr->second : nullptr;
     }
 
     template<typename T>
@@ -69,6 +147,11 @@ namespace uvw
     {
       if (has(key) && key.raw_ptr)
       {
+        if (Variable::data_lazy)
+        {
+          evaluate(key);
+          vars_[key]->hold();
+        }
         void* data_ptr = vars_[key]->data_ptr_;
         if (data_ptr)
         {
@@ -83,6 +166,25 @@ namespace uvw
     static std::vector<Processor*> schedule(const Duohash& key);
     static bool execute(const std::vector<Processor*>& seq, bool preprocess = false);
 
+    // lazy evaluation: bring a var up to date by processing only its stale
+    // upstream procs; touch marks a var's proc & its downstream as stale.
+    // vars written through ref() since are touched first (see
+    // Variable::hold)
+    static bool evaluate(const Duohash& key, bool preprocess = false);
+    static void touch(const Duohash& key);
+
+    // push mode: once a var is written, process its proc & the procs
+    // downstream of it through links, in dependency order, notifying
+    // subscriptions along (see Variable::subscribe); other procs are left
+    // as is. plans are cached per var until links or the var registry
+    // change. fails on cyclic links
+    static bool push(const Duohash& key, bool preprocess = false);
+
+    protected:
+    static void write_shared_(Processor* proc_ptr);
+
+    public:
+
     static std::string stats();
     static std::string summary();
 
@@ -97,6 +199,10 @@ namespace uvw
     static bool exists_(Processor* proc_ptr);
     static bool track_(Processor* proc_ptr);
     static bool untrack_(Processor* proc_ptr);
+    // untrack procs at once: their vars & the vars reading from them are
+    // unlinked in bulk (see Variable::unlink_), then unregistered in chunks
+    static void untrack_(const std::vector<Processor*>& proc_ptrs);
+    static void retype_(Processor* proc_ptr, const std::string& proc_type);
 
     // workspace instance vars/funcs
 
@@ -108,27 +214,236 @@ namespace uvw
     bool has_var(const Duohash& key);
     const std::vector<Processor*>& proc_ptrs() const {return proc_ptrs_;}
 
+    // deep-copy procs, var states, links & schedule of another workspace
+    bool clone(const Workspace& w);
+    // exchange procs, schedule & processing states with another workspace
+    // in constant time
+    void swap(Workspace& w);
+
     // proc json serialization
     json to_json();
     bool from_json(json& data);
     std::string to_str() {return to_json().serialize();}
     bool from_str(const std::string& str);
 
+    // binary checkpoint of all var values; trivially copyable values are
+    // copied raw, others through Variable::state_codecs. scattered values
+    // cost a cache miss each; pack first to copy them as whole slabs
+    bool save_state(std::vector<char>& buf);
+    bool load_state(const std::vector<char>& buf);
+
+    // delta updates of var values, enums & enabled flags, keyed by proc
+    // index & var label; to_delta emits the fields flagged since its last
+    // call (see Variable::mark_delta), apply_delta applies all or none
+    json to_delta();
+    bool apply_delta(json& data);
+
     // workspace processing
     bool set_input(const Duohash& key);
     bool set_output(const Duohash& key);
+    const Duohash& input() const {return in_;}
+    const Duohash& output() const {return out_;}
     bool process(bool preprocess = false);
     const std::vector<Processor*>& seq() {return seq_;}
+    // seq procs skipped by process as they only contribute to disabled
+    // vars (see Variable::enabled), as of the last process; preprocessing
+    // skips none
+    size_t pruned() const {return prune_.skipped;}
+    bool pruned(size_t i) const
+    {
+      return i < prune_.skip.size() && prune_.skip[i];
+    }
+
+    // fuse runs of fusible procs in the seq into single steps evaluating
+    // their kernels tile by tile; vars only read within a run are neither
+    // materialized nor pulled; preprocessing runs their procs one by one.
+    // unfuse restores per-proc processing
+    bool fuse();
+    void unfuse();
+    bool fused() const {return fused_;}
+
+    // move trivially copyable var values into contiguous per-type slabs,
+    // ordered by the processing seq; unpack restores per-var storage
+    bool pack();
+    bool unpack();
+    bool packed() const {return slabs_.size() > 0;}
 
     protected:
 
     // per-workspace proc container
     std::vector<Processor*> proc_ptrs_;
-    std::unordered_map<Duohash, Processor*> procs_by_keys_;
+    std::unordered_set<Processor*> procs_set_;
 
     Duohash in_, out_;
     std::vector<Processor*> seq_;
 
+    // pull copies of a seq, grouped per proc by type & size: trivially
+    // copyable values are copied raw with adjacent runs merged, others in
+    // typed loops, & shared values through their seqlocked pull. rebuilt
+    // when links or the var registry change
+    struct Pulls
+    {
+      struct Op
+      {
+        // typed loop, or raw copies of size bytes if null
+        Variable::CopyLoop loop;
+        size_t size;
+        // range of dsts & srcs
+        size_t begin, n;
+        // shared var pulled as is
+        Variable* var;
+      };
+      std::vector<Op> ops;
+      // op range per proc
+      std::vector<size_t> procs;
+      std::vector<void*> dsts;
+      std::vector<const void*> srcs;
+      Stamp stamp;
+    };
+    Pulls pulls_;
+    static void plan_pulls_(const std::vector<Processor*>& seq, Pulls& pulls);
+    static bool pull_(Pulls& pulls, size_t index);
+    static bool execute_(
+      const std::vector<Processor*>& seq,
+      Pulls* pulls,
+      bool preprocess,
+      const std::vector<char>* skip = nullptr
+    );
+    // process a single proc whose inputs are pulled; subscriptions are
+    // left to the caller unless notify
+    static bool process_(Processor* proc_ptr, bool preprocess,
+      bool notify = true);
+    // fire subscriptions of the vars of a processed proc
+    static void notify_(Processor* proc_ptr);
+
+    // push plans per written var; see push
+    struct Push
+    {
+      std::vector<Processor*> seq;
+      Pulls pulls;
+      Stamp stamp;
+    };
+    static std::unordered_map<Duohash, Push> pushes_;
+    // vars held by lazy refs; touched by evaluate if changed
+    static std::vector<Duohash> held_;
+    static void settle_();
+    // vars flagged by Variable::mark_delta; drained per workspace by to_delta
+    static std::vector<Duohash> deltas_;
+    static bool plan_push_(const Duohash& key, Push& push);
+    // process the seq (or its fused steps) once; the lock is held & the
+    // pruning plan is up to date
+    bool run_seq_(bool preprocess, bool pruning);
+
+    // processing steps of a fused seq; runs of non-fusible procs are kept
+    // as single steps without kernels
+    struct Step
+    {
+      struct Arg
+      {
+        // storage var, or nullptr for intermediate tiles
+        Variable* var;
+        bool batch;
+        bool input;
+      };
+      std::vector<Processor*> procs;
+      Pulls pulls;
+      std::vector<Kernel> kernels;
+      std::vector<Arg> args;
+      // arg indices per kernel
+      std::vector<std::vector<size_t> > ins, outs;
+      // scratch tiles & arg ptrs
+      std::vector<double> tiles;
+      std::vector<double*> ptrs;
+      std::vector<char> advance;
+      std::vector<const double*> in_ptrs;
+      std::vector<double*> out_ptrs;
+    };
+    static const size_t tile_size = 256;
+    std::vector<Step> steps_;
+    bool fused_;
+    Stamp fuse_stamp_;
+    bool run_(Step& step);
+
+    // pruning of seq procs contributing to disabled vars only. edges run
+    // from vars linked to, to the vars fed; procs are live through any
+    // edge of enabled vars into a live proc (or a proc outside the seq),
+    // if owning the output var, or if without edges. liveness is
+    // refcounted so toggles update the affected procs only. rebuilt when
+    // the seq, links or the var registry change
+    struct Prune
+    {
+      struct Edge
+      {
+        size_t src;
+        // seq index fed, npos if outside of or not later in the seq
+        size_t dst;
+        Variable* out;
+        Variable* in;
+        bool active;
+      };
+      std::vector<Edge> edges;
+      // edge range per proc & edges into each proc
+      std::vector<size_t> outs;
+      std::vector<std::vector<size_t> > ins;
+      // edges per var & the var states last seen
+      std::unordered_map<Variable*,
+        std::pair<bool, std::vector<size_t> > > vars;
+      std::vector<Processor*> seq;
+      std::unordered_map<Processor*, size_t> index;
+      std::vector<size_t> reasons;
+      std::vector<char> skip;
+      // skipped procs per fused step, & whether all are last
+      std::vector<std::vector<char> > steps;
+      size_t skipped = 0;
+      bool changed = false;
+      Stamp stamp;
+      uint64_t enabled_epoch = 0;
+    };
+    Prune prune_;
+    void prune_all_();
+    void prune_edge_(size_t e, std::vector<size_t>& flipped);
+    // bring the pruning up to date; returns whether procs are skipped
+    bool update_prune_();
+
+    // to_delta emits every var first & flagged vars only afterwards; proc
+    // indexes are re-made once procs change
+    bool delta_made_;
+    uint64_t delta_version_;
+    std::unordered_map<Processor*, size_t> delta_index_;
+
+    // workspace-owned var storage
+    struct Slab
+    {
+      std::type_index type;
+      std::vector<char> buf;
+      char* data;
+      size_t size;
+    };
+    std::vector<Slab> slabs_;
+    std::vector<Variable*> packed_vars_;
+
+    // state layout, rebuilt when the version changes; runs of values
+    // adjacent in memory are copied whole, while scattered small values
+    // are gathered per size through pointer tables
+    struct StateRun
+    {
+      char* ptr;
+      size_t offset;
+      size_t size;
+    };
+    std::vector<StateRun> state_runs_;
+    struct StateGather
+    {
+      size_t size;
+      size_t offset;
+      std::vector<char*> ptrs;
+    };
+    std::vector<StateGather> state_gathers_;
+    std::vector<std::pair<Variable*, StateCodec*> > state_codecs_;
+    size_t state_size_;
+    uint64_t state_version_;
+    bool layout_state_();
+
     public:
 
     Workspace();
@@ -136,12 +451,12 @@ namespace uvw
     Workspace(const Workspace& w);
     Workspace& operator=(const Workspace& w);
 
-    // vars/links/procs range-based
+    // vars/links/procs range-based; indexed views without copies
 
-    static std::unordered_set<Processor*> procs(
+    static Range<std::unordered_set<Processor*> > procs(
       const std::string& proc_type = std::string()
     );
-    static std::unordered_map<Duohash, Variable*> vars(
+    static Range<std::unordered_map<Duohash, Variable*> > vars(
       Processor* proc = nullptr
     );
     static std::unordered_map<Duohash, Duohash>& links() {return links_;}
@@ -152,10 +467,15 @@ namespace uvw
     protected:
 
     static std::map<std::string, std::function<Processor*()> > lib_;
+    // cleared procs kept for reuse, per proc type
+    static std::map<std::string, std::vector<Processor*> > pool_;
+    static bool recycle_(Processor* proc_ptr);
+    static Processor* reuse_(const std::string& proc_type);
 
     public:
 
     static bool clear_proc_lib();
+    static size_t pool_size(const std::string& proc_type);
     static bool reg_proc(
       const std::string& proc_type,
       std::function<Processor*()> proc_func
@@ -0,0 +1,216 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+using namespace uvw;
+
+
+typedef Array<double> Signal;
+typedef Array<double, 4> Quad;
+
+// y = x * s, over whole arrays
+struct Scale: public Processor
+{
+  Var<Signal> x_, y_;
+  Var<double> s_;
+  Var<Quad> q_;
+
+  bool initialize() override
+  {
+    s_() = 1.0;
+    return (
+      reg_var<Signal>("x", x_) &&
+      reg_var<Signal>("y", y_) &&
+      reg_var<double>("s", s_) &&
+      reg_var<Quad>("q", q_)
+    );
+  }
+
+  bool process(bool preprocess) override
+  {
+    auto& x = x_();
+    auto& y = y_();
+    if (y.shape() != x.shape())
+    {
+      y.resize(x.shape());
+    }
+    auto s = s_();
+    for (size_t i = 0; i < x.size(); i++)
+    {
+      y[i] = x[i] * s;
+    }
+    return true;
+  }
+};
+
+TEST_CASE("Arrays...", "[array]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  SECTION("Storage")
+  {
+    Signal a({2, 3});
+    REQUIRE( a.size() == 6 );
+    REQUIRE( a.dims() == 2 );
+    REQUIRE( (uintptr_t)a.data() % Signal::alignment == 0 );
+    REQUIRE( a[5] == 0 );
+    a.at({1, 2}) = 7;
+    REQUIRE( a[5] == 7 );
+    REQUIRE( a.reshape({3, 2}) == true );
+    REQUIRE( a.at({2, 1}) == 7 );
+    REQUIRE( a.reshape({4}) == false );
+
+    // copies share the buffer, clones do not
+    Signal b = a;
+    Signal c = a.clone();
+    REQUIRE( b.shares(a) == true );
+    REQUIRE( c.shares(a) == false );
+    REQUIRE( c == a );
+    b[0] = 1;
+    REQUIRE( a[0] == 1 );
+    REQUIRE( c != a );
+
+    // fixed-size arrays keep their element count
+    Quad q;
+    REQUIRE( q.size() == 4 );
+    REQUIRE( (uintptr_t)q.data() % Quad::alignment == 0 );
+    REQUIRE( q.resize({2, 2}) == true );
+    REQUIRE( q.resize({3}) == false );
+    REQUIRE( q.size() == 4 );
+
+    // element counts overflowing the allocatable bytes fail
+    const size_t wrap = (size_t(1) << 63) + 3;
+    size_t n;
+    REQUIRE( Signal::count({wrap, 2}, n) == false );
+    REQUIRE( c.resize({wrap, 2}) == false );
+    REQUIRE( c.reshape({wrap, 2}) == false );
+    REQUIRE( c.shape() == a.shape() );
+
+    // binary round trip
+    std::vector<char> buf;
+    a.save(buf);
+    Signal d;
+    REQUIRE( d.load(buf.data(), buf.size()) == buf.size() );
+    REQUIRE( d == a );
+    REQUIRE( d.shape() == a.shape() );
+    REQUIRE( q.load(buf.data(), buf.size()) == 0 );
+    REQUIRE( d.load(buf.data(), buf.size() - 1) == 0 );
+    uint64_t header[] = {2, uint64_t(1) << 62, 8};
+    std::vector<char> huge((char*)header, (char*)(header + 3));
+    REQUIRE( d.load(huge.data(), huge.size()) == 0 );
+    REQUIRE( d.shape() == a.shape() );
+  }
+
+  SECTION("Variables")
+  {
+    Var<Signal> v_;
+    REQUIRE( v_.type_str() == "double[]" );
+    v_().resize({2, 2});
+    v_()[3] = 0.5;
+    v_.values["default"] = v_().clone();
+    auto data = v_.to_json();
+
+    Var<Signal> u_;
+    REQUIRE( u_.from_json(data) == true );
+    REQUIRE( u_().shape() == std::vector<size_t>{2, 2} );
+    REQUIRE( u_()[3] == 0.5 );
+    REQUIRE( u_.default_value() == v_() );
+
+    // flat json arrays are read as 1-D
+    json flat;
+    REQUIRE( picojson::parse(flat, "{\"value\": [1, 2, 3]}").empty() );
+    REQUIRE( u_.patch_json(flat) == true );
+    REQUIRE( u_().shape() == std::vector<size_t>{3} );
+    REQUIRE( u_()[2] == 3 );
+
+    // shapes must match the data before allocating
+    for (auto str : {"{\"shape\":[1000000000],\"data\":[]}",
+      "{\"shape\":[-1,-3],\"data\":[1,2,3]}",
+      "{\"shape\":[\"3\"],\"data\":[1,2,3]}",
+      "{\"shape\":[4611686018427387904,4],\"data\":[]}"})
+    {
+      json bad;
+      REQUIRE( picojson::parse(bad, str).empty() );
+      Signal val({2});
+      REQUIRE( ValueTraits<Signal>::from_json(bad, val) == false );
+      REQUIRE( val.size() == 2 );
+
+      // vars are left as is
+      json bad_var(json::object{{"value", bad}});
+      REQUIRE( u_.patch_json(bad_var) == false );
+      REQUIRE( u_.from_json(bad_var) == false );
+      REQUIRE( u_().shape() == std::vector<size_t>{3} );
+      REQUIRE( u_.default_value() == v_() );
+    }
+
+    // state copies are deep
+    REQUIRE( u_.assign(&v_) == true );
+    REQUIRE( u_() == v_() );
+    REQUIRE( u_().shares(v_()) == false );
+  }
+
+  SECTION("Links")
+  {
+    uvw::ws::reg_proc("Scale", ([](){return new Scale();}));
+    uvw::var::data_pull = true;
+
+    // x -> [Scale] -> y -> [Scale] -> y
+    const size_t n = 1 << 16;
+    uvw::ws ws_;
+    auto* head = static_cast<Scale*>(ws_.new_proc("Scale"));
+    auto* tail = static_cast<Scale*>(ws_.new_proc("Scale"));
+    REQUIRE( tail->x_.link(&head->y_) == true );
+    REQUIRE( ws_.set_output(tail->y_.key()) == true );
+    head->x_().resize({n});
+    head->x_()[n - 1] = 2;
+    head->s_() = 3;
+    tail->s_() = 5;
+    REQUIRE( ws_.process() == true );
+    REQUIRE( tail->y_()[n - 1] == 30 );
+
+    // one link moves the whole block without copying elements
+    REQUIRE( tail->x_().shares(head->y_()) == true );
+    auto* data = head->y_().data();
+    REQUIRE( ws_.process() == true );
+    REQUIRE( tail->x_().data() == data );
+
+    // links are type-checked, fixed sizes included
+    REQUIRE( tail->x_.link(&head->s_) == false );
+    REQUIRE( tail->q_.link(&head->x_) == false );
+    REQUIRE( tail->q_.link(&head->q_) == true );
+    REQUIRE( tail->x_.link(&head->y_) == true );
+
+    // states are saved & restored through the registered codec
+    std::vector<char> state;
+    REQUIRE( ws_.save_state(state) == true );
+    REQUIRE( state.size() > n * sizeof(double) );
+    head->x_()[n - 1] = 0;
+    REQUIRE( ws_.load_state(state) == true );
+    REQUIRE( head->x_()[n - 1] == 2 );
+
+    // json round trip
+    uvw::ws copy_;
+    auto doc = ws_.to_json();
+    REQUIRE( copy_.from_json(doc) == true );
+    auto* copy_tail = static_cast<Scale*>(copy_.proc_ptrs()[1]);
+    REQUIRE( copy_.process() == true );
+    REQUIRE( copy_tail->y_()[n - 1] == 30 );
+    REQUIRE( copy_tail->x_().shares(head->y_()) == false );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    BENCHMARK("Process 64k array link")
+    {
+      return ws_.process();
+    };
+#endif
+
+    copy_.clear();
+    ws_.clear();
+  }
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
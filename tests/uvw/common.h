@@ -32,6 +32,20 @@ struct Multiply: public Processor
     z_() = x * y;
     return true;
   }
+
+  bool kernel(Kernel& k) override
+  {
+    k.ins = {&x_, &y_};
+    k.outs = {&z_};
+    k.eval = [](const double* const* in, double* const* out, size_t n)
+    {
+      for (size_t i = 0; i < n; i++)
+      {
+        out[0][i] = in[0][i] * in[1][i];
+      }
+    };
+    return true;
+  }
 };
 
 // Precomputed Addition Proc
@@ -63,6 +77,12 @@ struct PreAdd: public Processor
     c_() = d_;
     return true;
   }
+
+  bool assign(Processor* p) override
+  {
+    d_ = static_cast<PreAdd*>(p)->d_;
+    return true;
+  }
 };
 
 struct MyWorkpace: public uvw::Workspace
@@ -0,0 +1,294 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+using namespace uvw;
+
+#include "common.h"
+
+
+typedef std::vector<double> Batch;
+UVW_VAR_SPECIALIZE_DEFAULT(Batch)
+
+// y = x * s + b, with batch x & y and scalar s & b
+struct Affine: public Processor
+{
+  Var<Batch> x_, y_;
+  Var<double> s_, b_;
+
+  bool initialize() override
+  {
+    s_() = 1.0;
+    return (
+      reg_var<Batch>("x", x_) &&
+      reg_var<Batch>("y", y_) &&
+      reg_var<double>("s", s_) &&
+      reg_var<double>("b", b_)
+    );
+  }
+
+  bool process(bool preprocess) override
+  {
+    auto& x = x_();
+    auto& y = y_();
+    auto s = s_();
+    auto b = b_();
+    y.resize(x.size());
+    for (size_t i = 0; i < x.size(); i++)
+    {
+      y[i] = x[i] * s + b;
+    }
+    return true;
+  }
+
+  bool kernel(Kernel& k) override
+  {
+    k.ins = {&x_, &s_, &b_};
+    k.outs = {&y_};
+    k.eval = [](const double* const* in, double* const* out, size_t n)
+    {
+      for (size_t i = 0; i < n; i++)
+      {
+        out[0][i] = in[0][i] * in[1][i] + in[2][i];
+      }
+    };
+    return true;
+  }
+};
+
+// y = x * s + d, with d = 2 * b preprocessed
+struct Offset: public Processor
+{
+  Var<Batch> x_, y_;
+  Var<double> s_, b_;
+  double d_ = 0;
+
+  bool initialize() override
+  {
+    return (
+      reg_var<Batch>("x", x_) &&
+      reg_var<Batch>("y", y_) &&
+      reg_var<double>("s", s_) &&
+      reg_var<double>("b", b_)
+    );
+  }
+
+  bool preprocess() override
+  {
+    d_ = 2 * b_();
+    return true;
+  }
+
+  bool process(bool preprocess) override
+  {
+    auto& x = x_();
+    auto& y = y_();
+    y.resize(x.size());
+    for (size_t i = 0; i < x.size(); i++)
+    {
+      y[i] = x[i] * s_() + d_;
+    }
+    return true;
+  }
+
+  bool kernel(Kernel& k) override
+  {
+    k.ins = {&x_, &s_};
+    k.outs = {&y_};
+    k.eval = [this](const double* const* in, double* const* out, size_t n)
+    {
+      for (size_t i = 0; i < n; i++)
+      {
+        out[0][i] = in[0][i] * in[1][i] + d_;
+      }
+    };
+    return true;
+  }
+};
+
+// not fusible
+struct Negate: public Processor
+{
+  Var<Batch> x_, y_;
+
+  bool initialize() override
+  {
+    return reg_var<Batch>("x", x_) && reg_var<Batch>("y", y_);
+  }
+
+  bool process(bool preprocess) override
+  {
+    auto& x = x_();
+    auto& y = y_();
+    y.resize(x.size());
+    for (size_t i = 0; i < x.size(); i++)
+    {
+      y[i] = -x[i];
+    }
+    return true;
+  }
+};
+
+TEST_CASE("Kernel Fusion...", "[fuse]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+  uvw::ws::reg_proc("Affine", ([](){return new Affine();}));
+  uvw::ws::reg_proc("Negate", ([](){return new Negate();}));
+  uvw::ws::reg_proc("Offset", ([](){return new Offset();}));
+  uvw::var::data_pull = true;
+
+  SECTION("Scalar Chain")
+  {
+    // z = (a + b) * y^3, with y = 2
+    uvw::Workspace ws;
+    auto* p = ws.new_proc("PreAdd");
+    p->ref<double>("a") = 1.5;
+    p->ref<double>("b") = 2;
+    uvw::Processor* q = p;
+    for (int i = 0; i < 3; i++)
+    {
+      auto* m = ws.new_proc("Multiply");
+      m->ref<double>("y") = 2;
+      REQUIRE( m->get("x")->link(q->get(i? "z" : "c")) );
+      q = m;
+    }
+    REQUIRE( ws.set_output(uvw::duo(q, "z")) == true );
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( q->ref<double>("z") == 28 );
+
+    // PreAdd is processed as usual, the Multiply run as one step
+    REQUIRE( ws.fuse() == true );
+    REQUIRE( ws.fused() == true );
+    q->ref<double>("z") = 0;
+    p->ref<double>("a") = 2;
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( q->ref<double>("z") == 32 );
+
+    // preprocessing runs the procs one by one; processing leaves the
+    // intermediate z as is
+    REQUIRE( ws.seq()[1]->ref<double>("z") == 8 );
+    ws.seq()[1]->ref<double>("y") = 3;
+    REQUIRE( ws.process() == true );
+    REQUIRE( q->ref<double>("z") == 48 );
+    REQUIRE( ws.seq()[1]->ref<double>("z") == 8 );
+
+    // until linked to a consumer outside of the run
+    auto* r = ws.new_proc("Multiply");
+    REQUIRE( ws.process() == true );
+    REQUIRE( ws.seq()[1]->ref<double>("z") == 8 );
+    REQUIRE( r->get("x")->link(ws.seq()[1]->get("z")) );
+    REQUIRE( ws.process() == true );
+    REQUIRE( ws.seq()[1]->ref<double>("z") == 12 );
+
+    ws.unfuse();
+    REQUIRE( ws.fused() == false );
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( ws.seq()[1]->ref<double>("z") == 12 );
+    REQUIRE( q->ref<double>("z") == 48 );
+  }
+
+  SECTION("Batch Chain")
+  {
+    // y = ((x * 2 + 1) * 2 + 1)... & a non-fusible proc in between
+    const size_t n = 1000;
+    uvw::Workspace ws;
+    auto* src = ws.new_proc("Affine");
+    std::vector<uvw::Processor*> procs = {src};
+    for (int i = 0; i < 6; i++)
+    {
+      auto* a = ws.new_proc(i == 3? "Negate" : "Affine");
+      REQUIRE( a->get("x")->link(procs.back()->get("y")) );
+      if (i != 3)
+      {
+        a->ref<double>("s") = 2;
+        a->ref<double>("b") = 1;
+      }
+      procs.push_back(a);
+    }
+    auto& x = src->ref<Batch>("x");
+    for (size_t i = 0; i < n; i++)
+    {
+      x.push_back(i * 0.5);
+    }
+    REQUIRE( ws.set_output(uvw::duo(procs.back(), "y")) == true );
+    REQUIRE( ws.process() == true );
+    Batch expected = procs.back()->ref<Batch>("y");
+    REQUIRE( expected.size() == n );
+    REQUIRE( expected[10] == -(((5 * 2 + 1) * 2 + 1) * 2 + 1) * 4 + 3 );
+
+    // outputs read by the non-fusible Negate are materialized
+    procs[2]->ref<Batch>("y").clear();
+    procs[3]->ref<Batch>("y").clear();
+    procs.back()->ref<Batch>("y").clear();
+    REQUIRE( ws.fuse() == true );
+    REQUIRE( ws.process() == true );
+    REQUIRE( procs.back()->ref<Batch>("y") == expected );
+    REQUIRE( procs[3]->ref<Batch>("y").size() == n );
+    REQUIRE( procs[2]->ref<Batch>("y").size() == 0 );
+
+    // scalars broadcast over batches
+    procs.back()->ref<double>("b") = 0;
+    REQUIRE( ws.process() == true );
+    REQUIRE( procs.back()->ref<Batch>("y")[10] == expected[10] - 1 );
+
+    // a new output re-schedules & re-fuses on the next process
+    REQUIRE( ws.set_output(uvw::duo(procs[2], "y")) == true );
+    REQUIRE( ws.process() == true );
+    REQUIRE( procs[2]->ref<Batch>("y").size() == n );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    REQUIRE( ws.set_output(uvw::duo(procs.back(), "y")) == true );
+    x.resize(1 << 16);
+    ws.unfuse();
+    BENCHMARK("Unfused batch chain")
+    {
+      return ws.process();
+    };
+    ws.fuse();
+    BENCHMARK("Fused batch chain")
+    {
+      return ws.process();
+    };
+#endif
+  }
+
+  SECTION("Preprocessing & Scalar Outputs")
+  {
+    // y = x * (2 * 3) + 2 * b, in a single fused run
+    uvw::Workspace ws;
+    auto* m = ws.new_proc("Multiply");
+    auto* o = ws.new_proc("Offset");
+    m->ref<double>("x") = 2;
+    m->ref<double>("y") = 3;
+    REQUIRE( o->get("s")->link(m->get("z")) );
+    o->ref<Batch>("x") = Batch(10, 1);
+    o->ref<double>("b") = 1;
+    REQUIRE( ws.set_output(uvw::duo(o, "y")) == true );
+    REQUIRE( ws.fuse() == true );
+
+    // preprocessing is not skipped by fused runs
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( o->ref<Batch>("y")[9] == 8 );
+    o->ref<double>("b") = 2;
+    REQUIRE( ws.process() == true );
+    REQUIRE( o->ref<Batch>("y")[9] == 8 );
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( o->ref<Batch>("y")[9] == 10 );
+
+    // a materialized scalar output listed before the batch input
+    auto* r = ws.new_proc("Multiply");
+    REQUIRE( r->get("x")->link(m->get("z")) );
+    m->ref<double>("z") = 0;
+    REQUIRE( ws.process() == false );
+    REQUIRE( m->ref<double>("z") == 0 );
+  }
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
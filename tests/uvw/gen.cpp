@@ -0,0 +1,65 @@
+#include <catch2/catch.hpp>
+
+#include "ChainGraph.h"
+
+
+// generated from chain.json: z = (a + b) * y^7, with y = 1.5
+TEST_CASE("Generated Graph...", "[gen]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+
+  {
+    ChainGraph graph;
+    REQUIRE( graph.valid() == true );
+    REQUIRE( ChainGraph::size == 8 );
+    REQUIRE( uvw::ws::procs().size() == 8 );
+    REQUIRE( uvw::ws::links().size() == 7 );
+
+    // var states are restored from the json
+    REQUIRE( graph.proc_0().b_() == 2 );
+    REQUIRE( graph.proc_3().y_.values["max"] == 25.5 );
+    REQUIRE( graph.in() == 1.5 );
+
+    uvw::Workspace ws;
+    REQUIRE( ws.from_str(ChainGraph::source()) == true );
+    REQUIRE( ws.seq().size() == 8 );
+
+    REQUIRE( graph.process(true) == true );
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( graph.out() == Approx(3.5 * std::pow(1.5, 7)) );
+    REQUIRE( graph.out() == ws.proc_ptrs()[7]->ref<double>("z") );
+
+    graph.in() = 4.5;
+    graph.proc_7().y_.set(2);
+    ws.proc_ptrs()[0]->ref<double>("a") = 4.5;
+    ws.proc_ptrs()[7]->ref<double>("y") = 2;
+    REQUIRE( graph.process(true) == true );
+    REQUIRE( ws.process(true) == true );
+    REQUIRE( graph.out() == Approx(6.5 * std::pow(1.5, 6) * 2) );
+    REQUIRE( graph.out() == ws.proc_ptrs()[7]->ref<double>("z") );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    uvw::var::data_pull = true;
+    BENCHMARK("Generated graph")
+    {
+      return graph.process();
+    };
+    BENCHMARK("Workspace process")
+    {
+      return ws.process();
+    };
+#endif
+
+    ws.clear();
+  }
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
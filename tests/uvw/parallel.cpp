@@ -0,0 +1,449 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+using namespace uvw;
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+
+// y = a + b + c, after sleeping for t microseconds; fails if t < 0
+struct Sum: public Processor
+{
+  Var<double> a_, b_, c_, y_;
+  Var<int64_t> t_;
+
+  static std::mutex mutex;
+  static std::vector<Processor*> order;
+
+  bool initialize() override
+  {
+    return (
+      reg_var<double>("a", a_) &&
+      reg_var<double>("b", b_) &&
+      reg_var<double>("c", c_) &&
+      reg_var<double>("y", y_) &&
+      reg_var<int64_t>("t", t_)
+    );
+  }
+
+  bool process(bool preprocess) override
+  {
+    if (t_() < 0)
+    {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(t_()));
+    y_() = a_() + b_() + c_();
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(this);
+    return true;
+  }
+};
+std::mutex Sum::mutex;
+std::vector<Processor*> Sum::order;
+
+// poolable Sum
+struct PooledSum: public Sum
+{
+  bool reset() override
+  {
+    t_() = 0;
+    return true;
+  }
+};
+
+// procs processed in creation order
+struct DagWorkspace: public uvw::Workspace
+{
+  Sum* sum(size_t i) {return static_cast<Sum*>(proc_ptrs_[i]);}
+
+  // random dag; a & b of each proc are linked to y of earlier procs
+  void random(size_t n, std::mt19937& rng)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      auto* p = new_proc("Sum");
+      p->ref<double>("c") = (double)i;
+      for (auto label : {"a", "b"})
+      {
+        if (i && rng() % 4)
+        {
+          p->get(label)->link(proc_ptrs_[rng() % i]->get("y"));
+        }
+      }
+    }
+    sequence();
+  }
+
+  void sequence()
+  {
+    seq_ = proc_ptrs_;
+  }
+};
+
+TEST_CASE("Parallel...", "[parallel]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+
+  uvw::ws::reg_proc("Sum", ([](){return new Sum();}));
+  uvw::ws::reg_proc("PooledSum", ([](){return new PooledSum();}));
+  uvw::var::data_pull = true;
+
+  SECTION("Results")
+  {
+    std::mt19937 rng(7);
+    DagWorkspace ws;
+    ws.random(40, rng);
+    REQUIRE( ws.process() == true );
+    std::vector<double> expected;
+    for (auto* p : ws.seq())
+    {
+      expected.push_back(p->ref<double>("y"));
+    }
+
+    for (auto policy : {Parallel::FIFO, Parallel::CRITICAL_PATH})
+    {
+      Parallel par(ws, 4, policy);
+      REQUIRE( par.threads() == 4 );
+      for (int frame = 0; frame < 3; frame++)
+      {
+        for (auto* p : ws.seq())
+        {
+          p->ref<double>("y") = -1;
+        }
+        REQUIRE( par.process() == true );
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+          REQUIRE( ws.seq()[i]->ref<double>("y") == expected[i] );
+        }
+      }
+      REQUIRE( par.seq().size() == 40 );
+      REQUIRE( par.critical_path() > 0 );
+    }
+
+    // failures stop the frame
+    Parallel par(ws, 2);
+    ws.sum(20)->t_() = -1;
+    REQUIRE( par.process() == false );
+    ws.sum(20)->t_() = 0;
+    REQUIRE( par.process() == true );
+
+    ws.clear();
+  }
+
+  SECTION("Direct reads")
+  {
+    // without pulls, workers read inputs from their chain heads
+    std::mt19937 rng(11);
+    DagWorkspace ws;
+    ws.random(40, rng);
+    REQUIRE( ws.process() == true );
+    std::vector<double> expected;
+    for (auto* p : ws.seq())
+    {
+      expected.push_back(p->ref<double>("y"));
+    }
+
+    uvw::var::data_pull = false;
+    Parallel par(ws, 4, Parallel::CRITICAL_PATH);
+    auto check = [&]()
+    {
+      for (auto* p : ws.seq())
+      {
+        p->ref<double>("y") = -1;
+      }
+      REQUIRE( par.process() == true );
+      for (size_t i = 0; i < expected.size(); i++)
+      {
+        REQUIRE( ws.seq()[i]->ref<double>("y") == expected[i] );
+      }
+    };
+    check();
+    check();
+
+    // re-linked between frames
+    ws.sum(39)->get("a")->link(ws.sum(0)->get("y"));
+    expected[39] = expected[0] + ws.sum(39)->b_() + 39;
+    check();
+
+    uvw::var::data_pull = true;
+    ws.clear();
+  }
+
+  SECTION("Priorities")
+  {
+    // light procs l0..l2 & a heavy chain h0 -> h1
+    DagWorkspace ws;
+    for (int i = 0; i < 5; i++)
+    {
+      ws.new_proc("Sum");
+    }
+    auto* h0 = ws.sum(3);
+    auto* h1 = ws.sum(4);
+    h0->t_() = 2000;
+    h1->t_() = 2000;
+    h1->get("a")->link(h0->get("y"));
+    ws.sequence();
+
+    // single worker; the start order is the ready order
+    Parallel par(ws, 1);
+    Sum::order.clear();
+    REQUIRE( par.process() == true );
+    REQUIRE( Sum::order == std::vector<Processor*>(
+      ws.proc_ptrs().begin(), ws.proc_ptrs().end()) );
+    REQUIRE( par.cost(3) >= 0.002 );
+    REQUIRE( par.cost(0) < par.cost(3) );
+
+    par.set_policy(Parallel::CRITICAL_PATH);
+    Sum::order.clear();
+    REQUIRE( par.process() == true );
+    // light procs are ordered by their measured costs
+    REQUIRE( Sum::order.size() == 5 );
+    REQUIRE( Sum::order[0] == h0 );
+    REQUIRE( Sum::order[1] == h1 );
+    REQUIRE( par.rank(3) > par.rank(4) );
+    REQUIRE( par.rank(4) > par.rank(0) );
+    REQUIRE( par.critical_path() >= par.cost(3) + par.cost(4) );
+
+    // re-planned on link changes; costs are kept
+    double cost = par.cost(3);
+    h1->get("b")->link(ws.sum(2)->get("y"));
+    Sum::order.clear();
+    REQUIRE( par.process() == true );
+    REQUIRE( par.cost(3) != cost );
+    REQUIRE( Sum::order[0] == h0 );
+    REQUIRE( Sum::order[1] == ws.sum(2) );
+    REQUIRE( Sum::order[2] == h1 );
+
+    ws.clear();
+  }
+
+  SECTION("Placement")
+  {
+    std::mt19937 rng(5);
+    DagWorkspace ws;
+    ws.random(30, rng);
+    REQUIRE( ws.process() == true );
+    std::vector<double> expected;
+    for (auto* p : ws.seq())
+    {
+      expected.push_back(p->ref<double>("y"));
+    }
+    auto check = [&](Parallel& par)
+    {
+      for (auto* p : ws.seq())
+      {
+        p->ref<double>("y") = -1;
+      }
+      REQUIRE( par.process() == true );
+      for (size_t i = 0; i < expected.size(); i++)
+      {
+        REQUIRE( ws.seq()[i]->ref<double>("y") == expected[i] );
+      }
+    };
+
+    Parallel par(ws, 3, Parallel::CRITICAL_PATH);
+    REQUIRE( Parallel::cpu_node(0) >= 0 );
+    REQUIRE( par.place({}) == false );
+    REQUIRE( par.place({-1, 1 << 20}) == false );
+    REQUIRE( par.placed() == false );
+
+    // a single node keeps a single partition & the var storage
+    void* own = ws.sum(7)->get("y")->raw_data();
+    REQUIRE( par.place({0}) == true );
+    REQUIRE( par.placed() == true );
+    check(par);
+    REQUIRE( par.parts() == 1 );
+    REQUIRE( par.remote_links().empty() );
+    REQUIRE( ws.sum(7)->get("y")->raw_data() == own );
+
+    // two nodes emulated on cpu 0; vars are moved to storage per node
+    REQUIRE( par.place({0, 0}, {0, 1}) == true );
+    REQUIRE( par.parts() == 2 );
+    REQUIRE( par.part_node(1) == 1 );
+    REQUIRE( par.part(0) == 0 );
+    REQUIRE( par.part(29) == 1 );
+    REQUIRE( ws.sum(7)->get("y")->raw_data() != own );
+    REQUIRE( ws.sum(7)->ref<double>("c") == 7 );
+    check(par);
+    check(par);
+    auto remote = par.remote_links();
+    REQUIRE( remote.size() > 0 );
+    for (const auto& link : remote)
+    {
+      REQUIRE( uvw::ws::get(link.second)->src() == link.first );
+    }
+
+    // re-placed on changes of the seq
+    ws.sum(29)->get("a")->link(ws.sum(0)->get("y"));
+    expected[29] = expected[0] + ws.sum(29)->ref<double>("b") + 29;
+    check(par);
+    REQUIRE( par.parts() == 2 );
+
+    par.unplace();
+    REQUIRE( par.placed() == false );
+    REQUIRE( par.parts() == 1 );
+    REQUIRE( ws.sum(7)->get("y")->raw_data() == own );
+    check(par);
+
+    // packed vars stay in their slabs
+    REQUIRE( ws.pack() == true );
+    void* packed = ws.sum(7)->get("y")->raw_data();
+    REQUIRE( par.place({0, 0}, {0, 1}) == true );
+    REQUIRE( ws.sum(7)->get("y")->raw_data() == packed );
+    check(par);
+    par.unplace();
+    ws.unpack();
+
+    ws.clear();
+
+    // procs pooled while placed get their own storage back
+    {
+      DagWorkspace pws;
+      for (int i = 0; i < 4; i++)
+      {
+        auto* p = pws.new_proc("PooledSum");
+        p->ref<double>("c") = i;
+        if (i)
+        {
+          p->get("a")->link(pws.sum(i - 1)->get("y"));
+        }
+      }
+      pws.sequence();
+      Parallel placed(pws, 2);
+      REQUIRE( placed.place({0, 0}, {0, 1}) == true );
+      REQUIRE( placed.process() == true );
+      pws.clear();
+    }
+    DagWorkspace reused;
+    auto* p = static_cast<Sum*>(reused.new_proc("PooledSum"));
+    REQUIRE( p->get("y")->raw_data() == (void*)&p->y_() );
+    p->y_() = 5;
+    REQUIRE( p->y_() == 5 );
+    reused.clear();
+  }
+
+  SECTION("Pruning")
+  {
+    // s0 -> s1.a & s0 -> s2.a; s1 & s2 are sinks
+    DagWorkspace ws;
+    for (int i = 0; i < 3; i++)
+    {
+      ws.new_proc("Sum")->ref<double>("c") = i;
+    }
+    ws.sum(1)->get("a")->link(ws.sum(0)->get("y"));
+    ws.sum(2)->get("a")->link(ws.sum(0)->get("y"));
+    ws.sequence();
+
+    Parallel par(ws, 2, Parallel::CRITICAL_PATH);
+    ws.sum(1)->a_.set_enabled(false);
+    ws.sum(0)->y_() = -1;
+    REQUIRE( par.process() == true );
+    REQUIRE( ws.pruned() == 0 );
+    REQUIRE( ws.sum(0)->y_() == 0 );
+
+    ws.sum(2)->a_.set_enabled(false);
+    ws.sum(0)->y_() = -1;
+    Sum::order.clear();
+    REQUIRE( par.process() == true );
+    REQUIRE( ws.pruned() == 1 );
+    REQUIRE( ws.sum(0)->y_() == -1 );
+    REQUIRE( Sum::order.size() == 2 );
+    REQUIRE( ws.sum(2)->y_() == 1 );
+
+    ws.clear();
+  }
+
+  SECTION("Subscriptions")
+  {
+    // s0 -> s1 -> s2
+    DagWorkspace ws;
+    for (int i = 0; i < 3; i++)
+    {
+      auto* p = ws.new_proc("PooledSum");
+      p->ref<double>("c") = 1;
+      if (i)
+      {
+        p->get("a")->link(ws.sum(i - 1)->get("y"));
+      }
+    }
+    ws.sequence();
+
+    // fired on the caller in seq order; one-shot ones unsubscribe
+    std::vector<size_t> fired;
+    auto caller = std::this_thread::get_id();
+    bool on_caller = true;
+    size_t once_id = 0;
+    for (size_t i = 0; i < 3; i++)
+    {
+      ws.sum(i)->y_.subscribe([&, i](uvw::Variable*)
+        {
+          on_caller = on_caller &&
+            std::this_thread::get_id() == caller;
+          fired.push_back(i);
+        }
+      );
+    }
+    once_id = ws.sum(1)->y_.subscribe([&](uvw::Variable* v)
+      {
+        v->unsubscribe(once_id);
+      }
+    );
+    Parallel par(ws, 2);
+    REQUIRE( par.process() == true );
+    REQUIRE( on_caller == true );
+    REQUIRE( fired == std::vector<size_t>({0, 1, 2}) );
+    REQUIRE( ws.sum(1)->y_.unsubscribe(once_id) == false );
+
+    // failed procs & those after are not notified
+    ws.sum(0)->c_() = 2;
+    ws.sum(1)->t_() = -1;
+    fired.clear();
+    REQUIRE( par.process() == false );
+    REQUIRE( fired == std::vector<size_t>({0}) );
+
+    // subscriptions are dropped once pooled
+    ws.clear();
+    DagWorkspace reused;
+    auto* p = static_cast<Sum*>(reused.new_proc("PooledSum"));
+    REQUIRE( p->y_.subscribed() == false );
+    reused.clear();
+  }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+  SECTION("Skewed costs")
+  {
+    // few expensive procs among many cheap ones
+    std::mt19937 rng(11);
+    DagWorkspace ws;
+    ws.random(200, rng);
+    for (size_t i = 0; i < 200; i++)
+    {
+      ws.sum(i)->t_() = (rng() % 10)? 100 : 3000;
+    }
+
+    Parallel fifo(ws, 4, Parallel::FIFO);
+    Parallel cp(ws, 4, Parallel::CRITICAL_PATH);
+    REQUIRE( cp.process() == true );
+    BENCHMARK("FIFO 4 threads")
+    {
+      return fifo.process();
+    };
+    BENCHMARK("Critical path 4 threads")
+    {
+      return cp.process();
+    };
+
+    ws.clear();
+  }
+#endif
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
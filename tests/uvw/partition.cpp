@@ -0,0 +1,162 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+#include <uvw/partition.h>
+using namespace uvw;
+
+#include "common.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+TEST_CASE("Partitions...", "[partition]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+  uvw::var::data_pull = true;
+
+  // z = (a + b) * y0 * 2^(n - 1), with y0 as the input
+  const size_t n = 12;
+  uvw::ws ws_;
+  auto* p = static_cast<PreAdd*>(ws_.new_proc("PreAdd"));
+  p->a_() = 1;
+  p->b_() = 2;
+  std::vector<Multiply*> mults;
+  for (size_t i = 0; i < n; i++)
+  {
+    auto* m = static_cast<Multiply*>(ws_.new_proc("Multiply"));
+    m->y_() = 2;
+    REQUIRE( m->x_.link(i? &mults.back()->z_ : &p->c_) == true );
+    mults.push_back(m);
+  }
+  REQUIRE( ws_.set_input(mults[0]->y_.key()) == true );
+  REQUIRE( ws_.set_output(mults.back()->z_.key()) == true );
+  auto* in = &mults[0]->y_;
+  auto* out = &mults.back()->z_;
+
+  SECTION("Plan")
+  {
+    uvw::Partition::Plan plan;
+    REQUIRE( uvw::Partition::plan(ws_, 3, plan) == true );
+    REQUIRE( plan.begins == std::vector<size_t>{0, 4, 8, 13} );
+    REQUIRE( plan.links == 2 );
+    // two cut links, the input & the output
+    REQUIRE( plan.vars.size() == 4 );
+    REQUIRE( plan.imports.size() == 4 );
+    REQUIRE( plan.imports[0].size() == 1 );
+    REQUIRE( plan.imports[3].size() == 1 );
+    REQUIRE( plan.vars[plan.imports[3][0]] == out );
+    REQUIRE( uvw::Partition::plan(ws_, n + 2, plan) == false );
+  }
+
+  SECTION("Processes")
+  {
+    uvw::Partition part(ws_);
+    REQUIRE( part.process() == false );
+    REQUIRE( part.spawn(3) == true );
+    REQUIRE( part.size() == 3 );
+
+    // parts run in the workers only; the output lands locally
+    mults[n / 2]->z_() = -1;
+    REQUIRE( part.process(true) == true );
+    REQUIRE( out->ref() == 3 * 4096 );
+    REQUIRE( mults[n / 2]->z_() == -1 );
+    in->ref() = 1;
+    REQUIRE( part.process() == true );
+    REQUIRE( out->ref() == 3 * 2048 );
+
+    // pipelined frames, in order
+    std::vector<double> res;
+    REQUIRE( part.run(10,
+      [&](size_t f) {in->ref() = f; return true;},
+      [&](size_t f) {res.push_back(out->ref()); return f == res.size() - 1;}
+    ) == true );
+    REQUIRE( res.size() == 10 );
+    for (size_t f = 0; f < res.size(); f++)
+    {
+      REQUIRE( res[f] == 3 * 2048 * f );
+    }
+
+    // edits on the coordinator travel with the next frame; (2 + 2) * 3
+    in->ref() = 1;
+    p->a_.set(2);
+    mults.back()->y_.set(3);
+    REQUIRE( part.process(true) == true );
+    REQUIRE( out->ref() == 4 * 1024 * 3 );
+    mults.back()->y_.enums = {{"Five", 5}};
+    mults.back()->y_.mark_delta(uvw::var::DELTA_ENUMS);
+    REQUIRE( mults.back()->y_.set_enum("Five") == true );
+    REQUIRE( part.process(true) == true );
+    REQUIRE( out->ref() == 4 * 1024 * 5 );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    BENCHMARK("Process 100 pipelined frames over 3 parts")
+    {
+      return part.run(100);
+    };
+#endif
+
+    REQUIRE( part.stop() == true );
+    REQUIRE( part.process() == false );
+  }
+
+  SECTION("Input read across parts")
+  {
+    // the last y reads the input too; it is relayed from the coordinator
+    REQUIRE( mults.back()->y_.link(in) == true );
+    uvw::Partition part(ws_);
+    REQUIRE( part.spawn(2) == true );
+    in->ref() = 1;
+    REQUIRE( part.process(true) == true );
+    REQUIRE( out->ref() == 3 * 1024 );
+    in->ref() = 3;
+    REQUIRE( part.process() == true );
+    REQUIRE( out->ref() == 3 * 3 * 1024 * 3 );
+    REQUIRE( part.stop() == true );
+  }
+
+  SECTION("Sockets")
+  {
+    // a worker connecting over a Unix domain socket path
+    const std::string path = "/tmp/uvw_tests_" + std::to_string(getpid());
+    unlink(path.c_str());
+    int fd = uvw::SocketTransport::listen(path);
+    REQUIRE( fd >= 0 );
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      uvw::SocketTransport t;
+      _exit(t.connect(path) && uvw::Partition::serve(ws_, t)? 0 : 1);
+    }
+    REQUIRE( pid > 0 );
+    std::unique_ptr<uvw::SocketTransport> t(new uvw::SocketTransport());
+    REQUIRE( t->accept(fd) == true );
+    close(fd);
+    unlink(path.c_str());
+
+    std::vector<std::unique_ptr<uvw::Transport> > workers;
+    workers.push_back(std::move(t));
+    uvw::Partition part(ws_);
+    REQUIRE( part.start(std::move(workers)) == true );
+    REQUIRE( part.plan().links == 0 );
+    REQUIRE( part.process(true) == true );
+    REQUIRE( out->ref() == 3 * 4096 );
+    REQUIRE( part.stop() == true );
+
+    int status = -1;
+    REQUIRE( waitpid(pid, &status, 0) == pid );
+    REQUIRE( WIFEXITED(status) );
+    REQUIRE( WEXITSTATUS(status) == 0 );
+  }
+
+  ws_.clear();
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
@@ -88,6 +88,17 @@ TEST_CASE("Processors...", "[proc]")
 #endif
   REQUIRE( mult->z_() == 36 );
 
+  // clones carry internal proc states; (6 + 3) * 4 = 36 as well
+  {
+    uvw::ws replica;
+    REQUIRE( replica.clone(mws) == true );
+    REQUIRE( replica.process() == true );
+    auto* r_mult = static_cast<Multiply*>(replica.proc_ptrs()[1]);
+    REQUIRE( r_mult != mult );
+    REQUIRE( r_mult->z_() == 36 );
+    replica.clear();
+  }
+
   // json serialization
   auto json_stream = mws.to_json();
 
@@ -113,4 +124,70 @@ TEST_CASE("Processors...", "[proc]")
   // (8 + 3) * 2 = 22
   mws.process(true);
   REQUIRE( mult->ref<double>("z") == 22 );
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lazy Evaluation...", "[proc]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+
+  MyWorkpace mws;
+  auto* add = mws.preadd_proc();
+  auto* mult = mws.mult_proc();
+  // unrelated proc, not upstream of any read
+  auto* other = static_cast<Multiply*>(mws.new_proc("Multiply"));
+
+  // (2 + 3) * 7 = 35
+  add->a_.set(2);
+  add->b_.set(3);
+  mult->y_.set(7);
+  mws.process(true);
+  REQUIRE( mult->z_() == 35 );
+  REQUIRE( add->stale() == false );
+  REQUIRE( mult->stale() == false );
+  REQUIRE( other->stale() == true );
+
+  uvw::var::data_lazy = true;
+
+  // only 'mult' is stale; (2 + 3) * 4 = 20
+  mult->y_.set(4);
+  REQUIRE( add->stale() == false );
+  REQUIRE( mult->stale() == true );
+  REQUIRE( mult->z_() == 20 );
+  REQUIRE( mult->stale() == false );
+  REQUIRE( other->stale() == true );
+
+  // touching 'add' marks downstream 'mult' stale as well
+  add->a_.set(6);
+  REQUIRE( add->stale() == true );
+  REQUIRE( mult->stale() == true );
+
+  // (6 + 3) * 4 = 36, evaluated with pre-processing
+  REQUIRE( uvw::ws::evaluate(uvw::duo(mult, "z"), true) == true );
+  REQUIRE( add->stale() == false );
+  REQUIRE( mult->stale() == false );
+  REQUIRE( uvw::ws::ref<double>(uvw::duo(mult, "z")) == 36 );
+  REQUIRE( other->stale() == true );
+
+  // writes through refs are tracked; (1 + 3) * 4 = 16, (1 + 3) * 5 = 20
+  add->ref<double>("a") = 1;
+  REQUIRE( uvw::ws::evaluate(uvw::duo(mult, "z"), true) == true );
+  REQUIRE( mult->ref<double>("z") == 16 );
+  uvw::ws::ref<double>(uvw::duo(mult, "y")) = 5;
+  REQUIRE( mult->z_() == 20 );
+  // reads alone leave procs up to date
+  REQUIRE( add->ref<double>("a") == 1 );
+  REQUIRE( uvw::ws::evaluate(uvw::duo(mult, "z")) == true );
+  REQUIRE( add->stale() == false );
+  REQUIRE( mult->stale() == false );
+
+  uvw::var::data_lazy = false;
+  mws.clear();
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
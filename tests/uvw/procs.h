@@ -0,0 +1,10 @@
+#ifndef UVW_TESTS_PROCS_H
+#define UVW_TESTS_PROCS_H
+
+// test procs for generated code
+#include <uvw.h>
+using namespace uvw;
+
+#include "common.h"
+
+#endif
@@ -0,0 +1,187 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+using namespace uvw;
+
+#include "common.h"
+
+
+// z = (a + b) * y0 * y1 * ..., with n Multiply procs
+static json chain_json(size_t n, double a, double b, double y)
+{
+  uvw::Workspace ws;
+  auto* p = ws.new_proc("PreAdd");
+  p->ref<double>("a") = a;
+  p->ref<double>("b") = b;
+  uvw::Processor* q = p;
+  for (size_t i = 0; i < n; i++)
+  {
+    auto* m = ws.new_proc("Multiply");
+    m->ref<double>("y") = y;
+    m->get("x")->link(q->get(i? "z" : "c"));
+    q = m;
+  }
+  ws.set_output(uvw::duo(q, "z"));
+  return ws.to_json();
+}
+
+// exposes plan states
+struct LiveWorkspace: public uvw::Workspace
+{
+  bool planned() const {return pulls_.stamp.valid();}
+};
+
+TEST_CASE("Workspace Reload...", "[reload]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+  uvw::var::data_pull = true;
+
+  LiveWorkspace ws;
+  auto data = chain_json(1, 1, 2, 2);
+  REQUIRE( ws.from_json(data) == true );
+  REQUIRE( ws.process(true) == true );
+  REQUIRE( ws.proc_ptrs()[1]->ref<double>("z") == 6 );
+
+  // vars are read through procs while reloads may change the registry
+  auto mult = [&ws](size_t i)
+  {
+    return static_cast<Multiply*>(ws.proc_ptrs()[i]);
+  };
+
+  SECTION("Swap")
+  {
+    // runtime state of the live workspace
+    ws.proc_ptrs()[1]->ref<double>("y") = 5;
+    REQUIRE( ws.process() == true );
+    REQUIRE( ws.proc_ptrs()[1]->ref<double>("z") == 15 );
+
+    // definitions are prepared ahead; see Reload on registry changes
+    auto next = chain_json(2, 1, 2, 10);
+    auto again = chain_json(1, 2, 2, 1);
+    uvw::Reload reload(ws);
+    REQUIRE( reload.swap() == false );
+    REQUIRE( reload.start(next) == true );
+    REQUIRE( reload.start(next) == false );
+    REQUIRE( reload.busy() == true );
+
+    // the live workspace keeps processing while the new one is built
+    bool res = true;
+    while (!reload.ready() && reload.busy())
+    {
+      res = ws.process() && res;
+    }
+    REQUIRE( res == true );
+    REQUIRE( reload.wait() == true );
+    REQUIRE( ws.proc_ptrs().size() == 2 );
+    // building leaves the live plans as they are
+    REQUIRE( ws.planned() == true );
+    REQUIRE( reload.swap() == true );
+    REQUIRE( reload.swap() == false );
+
+    // matching vars carried over; new ones as defined & preprocessed
+    REQUIRE( ws.proc_ptrs().size() == 3 );
+    REQUIRE( mult(1)->y_() == 5 );
+    REQUIRE( mult(2)->y_() == 10 );
+    REQUIRE( ws.process() == true );
+    REQUIRE( mult(2)->z_() == 150 );
+
+    // the replaced procs are cleared in the background
+    while (reload.busy())
+    {
+      std::this_thread::yield();
+    }
+    REQUIRE( uvw::ws::procs().size() == 3 );
+
+    // reloads can be repeated; carried values override defined ones
+    REQUIRE( reload.start(again) == true );
+    REQUIRE( reload.wait() == true );
+    REQUIRE( reload.swap() == true );
+    REQUIRE( ws.process() == true );
+    REQUIRE( static_cast<PreAdd*>(ws.proc_ptrs()[0])->a_() == 1 );
+    REQUIRE( mult(1)->z_() == 15 );
+  }
+
+  SECTION("Failure")
+  {
+    uvw::Reload reload(ws);
+    auto bad = chain_json(1, 1, 2, 2);
+    bad.get<json::object>()["procs"].get<json::array>()[1]
+      .get<json::object>()["type"] = json("Unknown");
+    REQUIRE( reload.start(bad) == true );
+    REQUIRE( reload.wait() == false );
+    REQUIRE( reload.swap() == false );
+    REQUIRE( reload.start(std::string("{")) == false );
+
+    // the live workspace is untouched
+    REQUIRE( ws.proc_ptrs().size() == 2 );
+    REQUIRE( ws.process() == true );
+    REQUIRE( mult(1)->z_() == 6 );
+  }
+
+  SECTION("Concurrent")
+  {
+    // fused live workspace processing while a large graph is built
+    REQUIRE( ws.fuse() == true );
+    auto next = chain_json(1000, 1, 0, 1);
+    auto again = chain_json(1, 1, 2, 2);
+    {
+      uvw::Reload reload(ws);
+      REQUIRE( reload.start(next) == true );
+      bool res = true;
+      while (!reload.ready() && reload.busy())
+      {
+        res = ws.process() && res;
+      }
+      REQUIRE( res == true );
+      REQUIRE( reload.swap() == true );
+      REQUIRE( ws.fused() == true );
+      REQUIRE( ws.proc_ptrs().size() == 1001 );
+      REQUIRE( ws.process() == true );
+      REQUIRE( mult(1000)->z_() == 6 );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+      BENCHMARK("Live frame 1000 procs")
+      {
+        return ws.process();
+      };
+      {
+        // built, swapped in & the replaced procs cleared in turn
+        uvw::Reload bench(ws);
+        BENCHMARK("Live frame 1000 procs during reloads")
+        {
+          if (bench.ready())
+          {
+            bench.swap();
+          }
+          if (!bench.busy())
+          {
+            bench.start(next);
+          }
+          return ws.process();
+        };
+      }
+      REQUIRE( ws.process() == true );
+      REQUIRE( mult(1000)->z_() == 6 );
+#endif
+
+      // pending reloads are dropped on destruction
+      while (!reload.start(again))
+      {
+        std::this_thread::yield();
+      }
+    }
+    REQUIRE( ws.proc_ptrs().size() == 1001 );
+    REQUIRE( uvw::ws::procs().size() == 1001 );
+  }
+
+  ws.clear();
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
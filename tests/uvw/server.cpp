@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+#include <uvw/server.h>
+using namespace uvw;
+
+#include "common.h"
+
+#include <unistd.h>
+
+
+static std::string call(uvw::SocketTransport& t, const std::string& req)
+{
+  std::vector<char> msg(req.begin(), req.end());
+  if (!t.send(msg) || !t.recv(msg))
+  {
+    return "";
+  }
+  return std::string(msg.begin(), msg.end());
+}
+
+TEST_CASE("Server...", "[server]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+  uvw::var::data_pull = true;
+
+  // z = (a + b) * y
+  std::string def;
+  {
+    MyWorkpace mws;
+    mws.preadd_proc()->a_() = 1;
+    mws.preadd_proc()->b_() = 2;
+    mws.mult_proc()->y_() = 3;
+    def = mws.to_str();
+    mws.clear();
+  }
+
+  const std::string path = "/tmp/uvw_tests_" + std::to_string(getpid());
+  {
+    uvw::Server server;
+    REQUIRE( server.load("mult", def) == true );
+    REQUIRE( server.load("mult", def) == false );
+    REQUIRE( server.load("bad", "{") == false );
+    REQUIRE( server.start(path) == true );
+    REQUIRE( server.load("late", def) == false );
+
+    uvw::SocketTransport t;
+    REQUIRE( t.connect(path) == true );
+    const std::string get = ",\"get\":[{\"index\":1,\"label\":\"z\"}]}";
+    REQUIRE( call(t, "{\"graph\":\"mult\",\"run\":true" + get) ==
+      "{\"ok\":true,\"values\":[9]}" );
+    REQUIRE( call(t, "{\"graph\":\"mult\",\"vars\":[{\"index\":1,"
+      "\"label\":\"y\",\"value\":5}],\"run\":true" + get) ==
+      "{\"ok\":true,\"values\":[15]}" );
+    REQUIRE( call(t, "{\"graph\":\"mult\",\"vars\":[{\"index\":0,"
+      "\"label\":\"a\",\"value\":2}],\"preprocess\":true" + get) ==
+      "{\"ok\":true,\"values\":[20]}" );
+
+    // failures are replied to
+    REQUIRE( call(t, "{\"graph\":\"none\"}").find("\"ok\":false") !=
+      std::string::npos );
+    REQUIRE( call(t, "[").find("\"ok\":false") != std::string::npos );
+    REQUIRE( call(t, "{\"graph\":\"mult\",\"get\":[{\"index\":7,"
+      "\"label\":\"z\"}]}") == "{\"ok\":false}" );
+    REQUIRE( call(t, "{\"graph\":\"mult\",\"get\":[1]}") ==
+      "{\"ok\":false}" );
+    for (auto vars : {"[1]", "[{\"index\":\"1\",\"label\":\"y\"}]",
+      "[{\"index\":1,\"label\":\"y\",\"value\":\"5\"}]"})
+    {
+      REQUIRE( call(t, "{\"graph\":\"mult\",\"vars\":" +
+        std::string(vars) + ",\"run\":true}").find("\"ok\":false") !=
+          std::string::npos );
+    }
+
+    // concurrent identical requests are coalesced into shared runs
+    const size_t clients = 4, n = 200;
+    std::vector<size_t> oks(clients, 0);
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < clients; c++)
+    {
+      threads.emplace_back([&, c]()
+        {
+          uvw::SocketTransport client;
+          if (!client.connect(path))
+          {
+            return;
+          }
+          for (size_t i = 0; i < n; i++)
+          {
+            oks[c] += call(client, "{\"graph\":\"mult\",\"run\":true" + get) ==
+              "{\"ok\":true,\"values\":[20]}";
+          }
+        }
+      );
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    for (auto ok : oks)
+    {
+      REQUIRE( ok == n );
+    }
+    REQUIRE( server.requests() == clients * n + 8 );
+    REQUIRE( server.runs() <= clients * n + 3 );
+    REQUIRE( server.batches() <= server.requests() );
+    REQUIRE( call(t, "{\"stats\":true}").find("\"requests\":808") !=
+      std::string::npos );
+
+    // finished connections are reaped
+    for (size_t i = 0; i < 20; i++)
+    {
+      uvw::SocketTransport client;
+      REQUIRE( client.connect(path) == true );
+      REQUIRE( call(client, "{\"stats\":true}") != "" );
+    }
+    usleep(10000);
+    uvw::SocketTransport last;
+    REQUIRE( last.connect(path) == true );
+    REQUIRE( call(last, "{\"stats\":true}") != "" );
+    REQUIRE( server.connections() <= 2 );
+
+    // idle connections are dropped on stop
+    server.stop();
+    REQUIRE( server.running() == false );
+    REQUIRE( call(t, "{\"graph\":\"mult\"}") == "" );
+    REQUIRE( access(path.c_str(), F_OK) != 0 );
+
+    server.graph("mult")->clear();
+  }
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
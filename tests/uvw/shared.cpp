@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+#include <uvw/shared.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+struct Square : uvw::Processor
+{
+    uvw::Var<double> x_, y_;
+    bool initialize() override
+    {
+        return reg_var<double>("x", x_) && reg_var<double>("y", y_);
+    }
+    bool process(bool preprocess) override
+    {
+        y_() = x_() * x_();
+        return true;
+    }
+};
+
+// stalls slots & holds the header lock as dying writers would
+struct StallStore : uvw::SharedStore
+{
+    void stall(const std::string& slot) {find_(slot)->seq.fetch_add(1);}
+    bool hold() {return lock_();}
+};
+
+TEST_CASE("Shared Store...", "[shared]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Square", ([](){return new Square();}));
+    uvw::var::data_pull = true;
+
+    const std::string name = "/uvw_tests_" + std::to_string(getpid());
+    uvw::SharedStore store;
+    REQUIRE( store.open(name, 4096) == true );
+
+    // y = x^2, with 'y' published to the shared segment
+    uvw::ws ws_;
+    auto* p = static_cast<Square*>(ws_.new_proc("Square"));
+    auto* q = static_cast<Square*>(ws_.new_proc("Square"));
+    REQUIRE( q->x_.link(&p->y_) == true );
+    p->x_.set(3);
+    void* own = p->y_.raw_data();
+    REQUIRE( store.bind(p->y_, "y") == true );
+    REQUIRE( p->y_.raw_data() == own );
+    REQUIRE( store.version("y") == 2 );
+    REQUIRE( ws_.set_output(q->y_.key()) == true );
+    REQUIRE( ws_.process() == true );
+
+    // published on bind & once processed; local links read own storage
+    double y = 0;
+    REQUIRE( store.read("y", y) == true );
+    REQUIRE( y == 9 );
+    REQUIRE( q->y_() == 81 );
+    REQUIRE( store.version("y") == 4 );
+
+    // another process links its input to 'y' & publishes 'z' = y^2
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        uvw::SharedStore child_store;
+        uvw::ws child_ws;
+        auto* r = static_cast<Square*>(child_ws.new_proc("Square"));
+        bool res = (
+            child_store.open(name) &&
+            child_store.link(r->x_, "y") &&
+            child_store.bind(r->y_, "z") &&
+            child_ws.set_output(r->y_.key()) &&
+            child_ws.process()
+        );
+        _exit(res? 0 : 1);
+    }
+    REQUIRE( pid > 0 );
+    int status = -1;
+    REQUIRE( waitpid(pid, &status, 0) == pid );
+    REQUIRE( WIFEXITED(status) );
+    REQUIRE( WEXITSTATUS(status) == 0 );
+
+    double z = 0;
+    REQUIRE( store.read("z", z) == true );
+    REQUIRE( z == 81 );
+    REQUIRE( store.version("z") == 4 );
+
+    // a writer dying mid-store fails reads rather than stalling them
+    uvw::var::seq_retries = 1000;
+    StallStore stall;
+    REQUIRE( stall.open(name) == true );
+    uvw::ws reader;
+    auto* r = static_cast<Square*>(reader.new_proc("Square"));
+    REQUIRE( stall.link(r->x_, "y") == true );
+    REQUIRE( reader.set_output(r->y_.key()) == true );
+    stall.stall("y");
+    REQUIRE( store.read("y", y) == false );
+    REQUIRE( reader.process() == false );
+    stall.stall("y");
+    REQUIRE( reader.process() == true );
+    REQUIRE( r->y_() == 81 );
+
+    // as does one dying with the header locked, which is taken over
+    pid = fork();
+    if (pid == 0)
+    {
+        StallStore child_store;
+        _exit(child_store.open(name) && child_store.hold()? 0 : 1);
+    }
+    REQUIRE( pid > 0 );
+    REQUIRE( waitpid(pid, &status, 0) == pid );
+    REQUIRE( WEXITSTATUS(status) == 0 );
+    REQUIRE( store.version("y") == 6 );
+    REQUIRE( store.read("y", y) == true );
+    stall.close();
+    reader.clear();
+    uvw::var::seq_retries = 100000;
+
+    // mismatched slot sizes
+    int32_t n = 0;
+    REQUIRE( store.read("y", n) == false );
+    REQUIRE( store.read("w", y) == false );
+
+    // closing stops publishing
+    store.close();
+    REQUIRE( uvw::SharedStore::remove(name) == true );
+    REQUIRE( p->y_.raw_data() == own );
+    REQUIRE( p->y_() == 9 );
+    p->x_.set(4);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( q->y_() == 256 );
+
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
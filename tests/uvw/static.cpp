@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+using namespace uvw;
+
+#include "common.h"
+
+
+// z = (a + b) * y, with procs listed out of processing order
+using MyGraph = uvw::StaticGraph<
+  uvw::Procs<Multiply, PreAdd>,
+  uvw::Links<
+    UVW_LINK(1, &PreAdd::c_, 0, &Multiply::x_)
+  >
+>;
+
+TEST_CASE("Static Graph...", "[static]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+  REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+  uvw::ws::reg_proc("PreAdd", ([](){return new PreAdd();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+
+  // topological order is resolved at compile time
+  static_assert(MyGraph::order(0) == 1, "PreAdd first");
+  static_assert(MyGraph::order(1) == 0, "Multiply second");
+
+  {
+    MyGraph graph({"Multiply", "PreAdd"});
+    REQUIRE( graph.valid() == true );
+    REQUIRE( uvw::ws::procs().size() == 2 );
+    REQUIRE( uvw::ws::vars().size() == 6 );
+
+    auto& add = graph.proc<1>();
+    auto& mult = graph.proc<0>();
+
+    // (2 + 3) * 7 = 35
+    add.a_.set(2);
+    add.b_.set(3);
+    mult.y_.set(7);
+    REQUIRE( graph.process(true) == true );
+    REQUIRE( mult.z_() == 35 );
+
+    // no pre-processing, (2 + 3) * 4 = 20
+    add.a_.set(6);
+    mult.y_.set(4);
+    REQUIRE( graph.process() == true );
+    REQUIRE( mult.z_() == 20 );
+
+    // to dynamic workspace & back
+    MyWorkpace mws;
+    REQUIRE( graph.to_workspace(mws) == true );
+    REQUIRE( mws.proc_ptrs().size() == 2 );
+    REQUIRE( uvw::ws::links().size() == 1 );
+    REQUIRE( mws.proc_ptrs()[0]->get("x")->src().raw_ptr ==
+      mws.proc_ptrs()[1] );
+    REQUIRE( mws.set_output(uvw::duo(mws.proc_ptrs()[0], "z")) == true );
+    REQUIRE( mws.process(true) == true );
+    REQUIRE( mws.proc_ptrs()[0]->ref<double>("z") == 36 );
+
+    mws.proc_ptrs()[1]->ref<double>("b") = 4;
+    REQUIRE( graph.from_workspace(mws) == true );
+    REQUIRE( graph.process(true) == true );
+    REQUIRE( mult.z_() == 40 );
+
+    // json round-trip
+    auto data = graph.to_json();
+    add.a_.set(0);
+    REQUIRE( graph.from_json(data) == true );
+    REQUIRE( add.a_() == 6 );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    uvw::var::data_pull = true;
+    BENCHMARK("Static graph")
+    {
+      return graph.process();
+    };
+    BENCHMARK("Dynamic workspace")
+    {
+      return mws.process();
+    };
+#endif
+
+    mws.clear();
+  }
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
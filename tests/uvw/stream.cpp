@@ -0,0 +1,279 @@
+#include <catch2/catch.hpp>
+
+#include <uvw.h>
+using namespace uvw;
+
+#include "common.h"
+
+#include <thread>
+
+
+// y = x * k; fails if x < 0
+struct Gain: public Processor
+{
+  Var<double> x_, k_, y_;
+
+  bool initialize() override
+  {
+    k_() = 1;
+    return (
+      reg_var<double>("x", x_) &&
+      reg_var<double>("k", k_) &&
+      reg_var<double>("y", y_)
+    );
+  }
+
+  bool process(bool preprocess) override
+  {
+    if (x_() < 0)
+    {
+      return false;
+    }
+    y_() = x_() * k_();
+    return true;
+  }
+};
+
+TEST_CASE("Stream...", "[stream]")
+{
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+
+  uvw::ws::reg_proc("Gain", ([](){return new Gain();}));
+  uvw::ws::reg_proc("Multiply", ([](){return new Multiply();}));
+  uvw::var::data_pull = true;
+
+  SECTION("Ring")
+  {
+    uvw::Ring<int> ring(5);
+    REQUIRE( ring.capacity() == 8 );
+    REQUIRE( ring.empty() == true );
+
+    int val = 0;
+    REQUIRE( ring.pop(val) == false );
+    for (int i = 0; i < 8; i++)
+    {
+      REQUIRE( ring.push(i) == true );
+    }
+    REQUIRE( ring.push(8) == false );
+    REQUIRE( ring.size() == 8 );
+
+    // spans end at the wrap-around
+    for (int i = 0; i < 6; i++)
+    {
+      REQUIRE( ring.pop(val) == true );
+      REQUIRE( val == i );
+    }
+    for (int i = 8; i < 12; i++)
+    {
+      REQUIRE( ring.push(i) == true );
+    }
+    int* ptr;
+    REQUIRE( ring.read_span(ptr) == 2 );
+    REQUIRE( ptr[0] == 6 );
+    ring.consume(2);
+    REQUIRE( ring.read_span(ptr) == 4 );
+    REQUIRE( ptr[3] == 11 );
+    ring.consume(4);
+    REQUIRE( ring.empty() == true );
+    REQUIRE( ring.write_span(ptr) == 4 );
+
+    // concurrent producer & consumer
+    uvw::Ring<int> fifo(64);
+    const int n = 100000;
+    std::thread producer([&]()
+      {
+        for (int i = 0; i < n; i++)
+        {
+          while (!fifo.push(i))
+          {
+            std::this_thread::yield();
+          }
+        }
+      }
+    );
+    bool ordered = true;
+    for (int i = 0; i < n; i++)
+    {
+      while (!fifo.pop(val))
+      {
+        std::this_thread::yield();
+      }
+      ordered = ordered && (val == i);
+    }
+    producer.join();
+    REQUIRE( ordered == true );
+  }
+
+  SECTION("Samples")
+  {
+    // y = x * 2 * 3
+    uvw::Workspace ws;
+    auto* s0 = static_cast<Gain*>(ws.new_proc("Gain"));
+    auto* s1 = static_cast<Gain*>(ws.new_proc("Gain"));
+    s0->k_() = 2;
+    s1->k_() = 3;
+    s1->x_.link(&s0->y_);
+
+    uvw::Stream<double> stream(ws);
+    std::vector<double> xs = {1, 2, 3, 4}, ys;
+    REQUIRE( stream.run(xs.begin(), xs.end(), std::back_inserter(ys)) == 0 );
+    REQUIRE( stream.failed() == true );
+
+    REQUIRE( ws.set_input(s0->x_.key()) == true );
+    REQUIRE( ws.set_output(s1->y_.key()) == true );
+    REQUIRE( ws.input() == s0->x_.key() );
+    REQUIRE( ws.output() == s1->y_.key() );
+    uvw::Stream<int64_t, double> mistyped(ws);
+    std::vector<int64_t> is = {1};
+    REQUIRE( mistyped.run(is.begin(), is.end(), std::back_inserter(ys)) ==
+      0 );
+
+    REQUIRE( stream.run(xs.begin(), xs.end(), std::back_inserter(ys)) == 4 );
+    REQUIRE( stream.failed() == false );
+    REQUIRE( ys == std::vector<double>({6, 12, 18, 24}) );
+
+    // failures stop the run
+    xs = {5, -1, 6};
+    ys.clear();
+    REQUIRE( stream.run(xs.begin(), xs.end(), std::back_inserter(ys)) == 1 );
+    REQUIRE( stream.failed() == true );
+    REQUIRE( ys == std::vector<double>({30}) );
+
+    // backpressure: samples stay queued while the output ring is full
+    uvw::Ring<double> in(16), out(4);
+    for (int i = 0; i < 10; i++)
+    {
+      REQUIRE( in.push(i) == true );
+    }
+    stream.batch = 3;
+    REQUIRE( stream.pump(in, out) == 4 );
+    REQUIRE( in.size() == 6 );
+    REQUIRE( stream.pump(in, out) == 0 );
+    double y;
+    for (int i = 0; i < 4; i++)
+    {
+      REQUIRE( out.pop(y) == true );
+      REQUIRE( y == 6 * i );
+    }
+    REQUIRE( stream.pump(in, out, 1) == 1 );
+    REQUIRE( stream.pump(in, out) == 3 );
+    REQUIRE( in.size() == 2 );
+
+    // the failing sample is left queued
+    REQUIRE( out.pop(y) == true );
+    REQUIRE( y == 24 );
+    while (out.pop(y));
+    in.pop(y);
+    in.pop(y);
+    REQUIRE( in.push(-1) == true );
+    REQUIRE( stream.pump(in, out) == 0 );
+    REQUIRE( stream.failed() == true );
+    REQUIRE( in.size() == 1 );
+    in.pop(y);
+
+    // re-bound on changes of the output var
+    REQUIRE( ws.set_output(s0->y_.key()) == true );
+    xs = {1, 2};
+    ys.clear();
+    REQUIRE( stream.run(xs.begin(), xs.end(), std::back_inserter(ys)) == 2 );
+    REQUIRE( ys == std::vector<double>({2, 4}) );
+
+    ws.clear();
+  }
+
+  SECTION("Producer & consumer")
+  {
+    // fused y = x * 2 * 3, fed & drained by other threads
+    uvw::Workspace ws;
+    auto* m0 = static_cast<Multiply*>(ws.new_proc("Multiply"));
+    auto* m1 = static_cast<Multiply*>(ws.new_proc("Multiply"));
+    m0->y_() = 2;
+    m1->y_() = 3;
+    m1->x_.link(&m0->z_);
+    REQUIRE( ws.set_input(m0->x_.key()) == true );
+    REQUIRE( ws.set_output(m1->z_.key()) == true );
+    REQUIRE( ws.fuse() == true );
+
+    const size_t n = 20000;
+    uvw::Ring<double> in(256), out(64);
+    uvw::Stream<double> stream(ws);
+    std::thread producer([&]()
+      {
+        for (size_t i = 0; i < n; i++)
+        {
+          while (!in.push((double)i))
+          {
+            std::this_thread::yield();
+          }
+        }
+      }
+    );
+    bool ordered = true;
+    std::thread consumer([&]()
+      {
+        double y;
+        for (size_t i = 0; i < n; i++)
+        {
+          while (!out.pop(y))
+          {
+            std::this_thread::yield();
+          }
+          ordered = ordered && (y == 6.0 * i);
+        }
+      }
+    );
+    size_t done = 0;
+    while (done < n)
+    {
+      size_t k = stream.pump(in, out);
+      REQUIRE( stream.failed() == false );
+      if (!k)
+      {
+        std::this_thread::yield();
+      }
+      done += k;
+    }
+    producer.join();
+    consumer.join();
+    REQUIRE( ordered == true );
+
+    ws.clear();
+  }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+  SECTION("Per sample")
+  {
+    uvw::Workspace ws;
+    auto* s0 = static_cast<Gain*>(ws.new_proc("Gain"));
+    auto* s1 = static_cast<Gain*>(ws.new_proc("Gain"));
+    s1->x_.link(&s0->y_);
+    REQUIRE( ws.set_input(s0->x_.key()) == true );
+    REQUIRE( ws.set_output(s1->y_.key()) == true );
+
+    std::vector<double> xs(10000, 1.0), ys(xs.size());
+    uvw::Stream<double> stream(ws);
+    BENCHMARK("Manual set & process, 10k samples")
+    {
+      for (size_t i = 0; i < xs.size(); i++)
+      {
+        s0->x_.set(xs[i]);
+        ws.process();
+        ys[i] = s1->y_();
+      }
+      return ys[0];
+    };
+    BENCHMARK("Stream, 10k samples")
+    {
+      return stream.run(xs.begin(), xs.end(), ys.begin());
+    };
+
+    ws.clear();
+  }
+#endif
+
+  REQUIRE( uvw::ws::procs().size() == 0 );
+  REQUIRE( uvw::ws::vars().size() == 0 );
+  REQUIRE( uvw::ws::links().size() == 0 );
+}
@@ -35,7 +35,7 @@ TEST_CASE("Variables...", "[var]")
 
     SECTION("JSON Serialize")
     {
-        v_.enabled = false;
+        v_.set_enabled(false);
         v_.enums = {
             {"Item1", 0.333},
             {"Item2", 0.667}
@@ -46,7 +46,7 @@ TEST_CASE("Variables...", "[var]")
 
         uvw::Var<double> u_;
         u_.from_json(data);
-        REQUIRE( u_.enabled == false );
+        REQUIRE( u_.enabled() == false );
         REQUIRE( u_.properties["parameter"] == PAR_INPUT );
         REQUIRE( u_.default_value() == -0.25 );
         REQUIRE( u_["Item0"] == -0.25 );
@@ -2,6 +2,10 @@
 
 #include <uvw.h>
 
+#include <cstring>
+#include <memory>
+#include <thread>
+
 
 struct A : uvw::Processor
 {
@@ -52,6 +56,16 @@ struct M : uvw::Processor
     }
 };
 
+// poolable proc
+struct P : uvw::Processor
+{
+    static int inits;
+    uvw::Var<double> p_;
+    bool initialize() override {inits++; return reg_var<double>("p", p_);}
+    bool reset() override {p_.set(0); return true;}
+};
+int P::inits = 0;
+
 TEST_CASE("Workspace ...", "[ws]")
 {
     // sanity
@@ -158,7 +172,7 @@ TEST_CASE("Workspace ...", "[ws]")
         REQUIRE( ws_.process() == true );
         REQUIRE( v_->get() == 1.73205 );
         REQUIRE( w_->get() == "bnode" );
-        REQUIRE( w_->enabled == false );
+        REQUIRE( w_->enabled() == false );
     }
 
     // compound vars
@@ -225,6 +239,40 @@ TEST_CASE("Workspace ...", "[ws]")
         REQUIRE( uvw::ws::workspaces().size() == 1 );
     }
 
+    SECTION("Proc Pool")
+    {
+        uvw::ws::reg_proc("P", ([](){return new P();}));
+        REQUIRE( uvw::ws::pool_size("A") == 0 );
+        REQUIRE( uvw::ws::pool_size("P") == 0 );
+
+        uvw::var::data_pull = true;
+        P::inits = 0;
+        auto* P_ = ws_.new_proc("P");
+        REQUIRE( ws_.proc_ptrs().size() == 4 );
+        REQUIRE( P::inits == 1 );
+        P_->get("p")->link(C_->get("cc"));
+        static_cast<P*>(P_)->p_.set(1.5);
+
+        auto json_str = ws_.to_str();
+        ws_.clear();
+        REQUIRE( uvw::ws::procs().size() == 0 );
+        REQUIRE( uvw::ws::vars().size() == 0 );
+        REQUIRE( uvw::ws::links().size() == 0 );
+        REQUIRE( uvw::ws::pool_size("A") == 0 );
+        REQUIRE( uvw::ws::pool_size("P") == 1 );
+
+        // reload re-registers the pooled proc without initialize()
+        REQUIRE( ws_.from_str(json_str) == true );
+        REQUIRE( uvw::ws::pool_size("P") == 0 );
+        REQUIRE( P::inits == 1 );
+        REQUIRE( ws_.proc_ptrs()[3] == P_ );
+        REQUIRE( uvw::ws::procs().size() == 4 );
+        REQUIRE( uvw::ws::vars().size() == 6 );
+        REQUIRE( uvw::ws::links().size() == 2 );
+        REQUIRE( P_->get("p")->src().raw_ptr == ws_.proc_ptrs()[2] );
+        REQUIRE( P_->ref<double>("p") == 1.5 );
+    }
+
     SECTION("Proc Library")
     {
         // cannot clear proc lib if procs exist
@@ -232,4 +280,1085 @@ TEST_CASE("Workspace ...", "[ws]")
         ws_.clear();
         REQUIRE( uvw::ws::clear_proc_lib() == true );
     }
-}
\ No newline at end of file
+}
+
+struct Inc : uvw::Processor
+{
+    uvw::Var<int64_t> i_, o_;
+    bool initialize() override
+    {
+        return reg_var<int64_t>("i", i_) && reg_var<int64_t>("o", o_);
+    }
+    bool process(bool preprocess) override
+    {
+        o_() = i_() + 1;
+        return true;
+    }
+};
+
+TEST_CASE("Workspace Clone...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Inc", ([](){return new Inc();}));
+    uvw::var::data_pull = true;
+
+    // chain of incrementers: o = i + n
+    const size_t n = 100;
+    uvw::ws ws_;
+    auto* head = ws_.new_proc("Inc");
+    auto* tail = head;
+    for (size_t i = 1; i < n; i++)
+    {
+        auto* proc = ws_.new_proc("Inc");
+        proc->get("i")->link(tail->get("o"));
+        tail = proc;
+    }
+    REQUIRE( ws_.set_output(uvw::duo(tail, "o")) == true );
+    head->get("i")->set_enabled(false);
+    static_cast<Inc*>(head)->i_.set(10);
+
+    uvw::ws replica;
+    REQUIRE( replica.clone(ws_) == true );
+    REQUIRE( uvw::ws::procs().size() == 2 * n );
+    REQUIRE( uvw::ws::links().size() == 2 * (n - 1) );
+    REQUIRE( uvw::ws::workspaces().size() == 2 );
+    REQUIRE( replica.seq().size() == n );
+    auto procs_str_ = [](uvw::ws& w)
+    {
+        return w.to_json().get<json::object>()["procs"].serialize();
+    };
+    REQUIRE( procs_str_(replica) == procs_str_(ws_) );
+
+    // replica procs are independent from the original's
+    auto* r_head = static_cast<Inc*>(replica.proc_ptrs()[0]);
+    auto* r_tail = static_cast<Inc*>(replica.proc_ptrs()[n - 1]);
+    REQUIRE( r_head != head );
+    REQUIRE( r_head->i_.enabled() == false );
+    r_head->i_.set(20);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( replica.process() == true );
+    REQUIRE( static_cast<Inc*>(tail)->o_() == 10 + n );
+    REQUIRE( r_tail->o_() == 20 + n );
+
+    // clones process concurrently, each on its own thread
+    const size_t n_threads = 4;
+    std::vector<std::unique_ptr<uvw::ws> > clones;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        clones.emplace_back(new uvw::ws());
+        REQUIRE( clones.back()->clone(ws_) == true );
+        static_cast<Inc*>(clones.back()->proc_ptrs()[0])->i_.set(100 * t);
+    }
+    std::vector<int64_t> outs(n_threads, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            bool ok = true;
+            for (size_t k = 0; k < 100; k++)
+            {
+                ok = clones[t]->process() && ok;
+            }
+            auto* c_tail = static_cast<Inc*>(clones[t]->proc_ptrs()[n - 1]);
+            outs[t] = ok? c_tail->o_() : -1;
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        REQUIRE( outs[t] == (int64_t)(100 * t + n) );
+    }
+    clones.clear();
+
+    // copy construction deep-copies as well
+    uvw::ws copied(ws_);
+    REQUIRE( uvw::ws::procs().size() == 3 * n );
+    REQUIRE( uvw::ws::workspaces().size() == 3 );
+    REQUIRE( copied.proc_ptrs()[0] != head );
+    REQUIRE( copied.process() == true );
+    REQUIRE( copied.seq().back() != tail );
+    REQUIRE( uvw::ws::ref<int64_t>(copied.seq().back()->get("o")->key()) ==
+        10 + n );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    BENCHMARK("Clone")
+    {
+        return replica.clone(ws_);
+    };
+    BENCHMARK("JSON Round-trip")
+    {
+        auto data = ws_.to_json();
+        replica.clear();
+        return replica.from_json(data);
+    };
+#endif
+
+    copied.clear();
+    replica.clear();
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+TEST_CASE("Workspace Delta...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Inc", ([](){return new Inc();}));
+    uvw::var::data_pull = true;
+
+    uvw::ws src_, dst_;
+    for (size_t i = 0; i < 3; i++)
+    {
+        src_.new_proc("Inc");
+    }
+    src_.proc_ptrs()[1]->get("i")->link(src_.proc_ptrs()[0]->get("o"));
+    src_.proc_ptrs()[2]->get("i")->link(src_.proc_ptrs()[1]->get("o"));
+    REQUIRE( dst_.from_str(src_.to_str()) == true );
+
+    // initial delta carries every var
+    auto delta = src_.to_delta();
+    REQUIRE( delta.get<json::object>()["vars"].get<json::array>().size() == 6 );
+
+    // no change, empty delta
+    delta = src_.to_delta();
+    REQUIRE( delta.get<json::object>()["vars"].get<json::array>().size() == 0 );
+
+    auto* head = static_cast<Inc*>(src_.proc_ptrs()[0]);
+    auto* tail = static_cast<Inc*>(src_.proc_ptrs()[2]);
+    head->i_.set(5);
+    tail->o_.set_enabled(false);
+    // direct writes are flagged by hand
+    tail->o_.enums = {{"Five", 5}, {"Six", 6}};
+    tail->o_.mark_delta(uvw::var::DELTA_ENUMS);
+
+    delta = src_.to_delta();
+    auto& var_list = delta.get<json::object>()["vars"].get<json::array>();
+    REQUIRE( var_list.size() == 2 );
+    auto& head_obj = var_list[0].get<json::object>();
+    REQUIRE( head_obj["index"].get<int64_t>() == 0 );
+    REQUIRE( head_obj["label"].get<std::string>() == "i" );
+    REQUIRE( head_obj["value"].get<int64_t>() == 5 );
+    REQUIRE( head_obj.find("enabled") == head_obj.end() );
+    auto& tail_obj = var_list[1].get<json::object>();
+    REQUIRE( tail_obj["index"].get<int64_t>() == 2 );
+    REQUIRE( tail_obj["label"].get<std::string>() == "o" );
+    REQUIRE( tail_obj["enabled"].get<bool>() == false );
+    REQUIRE( tail_obj["enums"].get<json::array>().size() == 2 );
+    REQUIRE( tail_obj.find("value") == tail_obj.end() );
+
+    // apply on a replica, only the listed vars are touched
+    auto* d_head = static_cast<Inc*>(dst_.proc_ptrs()[0]);
+    auto* d_tail = static_cast<Inc*>(dst_.proc_ptrs()[2]);
+    d_tail->o_.properties["parameter"] = 2;
+    REQUIRE( dst_.apply_delta(delta) == true );
+    REQUIRE( d_head->i_() == 5 );
+    REQUIRE( d_tail->o_.enabled() == false );
+    REQUIRE( d_tail->o_["Six"] == 6 );
+    REQUIRE( d_tail->o_.properties["parameter"] == 2 );
+    REQUIRE( dst_.set_output(d_tail->o_.key()) == true );
+    REQUIRE( dst_.process() == true );
+    REQUIRE( d_tail->o_() == 8 );
+
+    // applied fields are not relayed back, local changes still are
+    delta = dst_.to_delta();
+    REQUIRE( delta.get<json::object>()["vars"].get<json::array>().size() == 6 );
+    head->i_.set(6);
+    delta = src_.to_delta();
+    REQUIRE( dst_.apply_delta(delta) == true );
+    d_tail->o_.set_enabled(true);
+    delta = dst_.to_delta();
+    auto& echo_list = delta.get<json::object>()["vars"].get<json::array>();
+    REQUIRE( echo_list.size() == 1 );
+    auto& echo_obj = echo_list[0].get<json::object>();
+    REQUIRE( echo_obj["index"].get<int64_t>() == 2 );
+    REQUIRE( echo_obj["enabled"].get<bool>() == true );
+
+    // enums removed
+    tail->o_.enums.clear();
+    tail->o_.mark_delta(uvw::var::DELTA_ENUMS);
+    delta = src_.to_delta();
+    REQUIRE( dst_.apply_delta(delta) == true );
+    REQUIRE( d_tail->o_.enum_keys().size() == 0 );
+
+    // invalid proc index
+    json::object bad_var;
+    bad_var["index"] = json((int64_t)3);
+    bad_var["label"] = json("i");
+    json::object bad_obj;
+    bad_obj["vars"] = json(json::array{json(bad_var)});
+    json bad(bad_obj);
+    REQUIRE( dst_.apply_delta(bad) == false );
+
+    // all or none: a bad entry after a good one leaves the good one out
+    json::object good_var;
+    good_var["index"] = json((int64_t)0);
+    good_var["label"] = json("i");
+    good_var["value"] = json((int64_t)7);
+    bad_obj["vars"] = json(json::array{json(good_var), json(bad_var)});
+    bad = json(bad_obj);
+    REQUIRE( dst_.apply_delta(bad) == false );
+    REQUIRE( d_head->i_() == 6 );
+
+    src_.clear();
+    dst_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+TEST_CASE("Workspace State...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("A", ([](){return new A();}));
+    uvw::ws::reg_proc("B", ([](){return new B();}));
+
+    uvw::ws ws_;
+    auto* A_ = static_cast<A*>(ws_.new_proc("A"));
+    auto* B_ = static_cast<B*>(ws_.new_proc("B"));
+    A_->a_.set(0.5);
+    B_->b_.set(1.5);
+    B_->s_.set("checkpoint");
+
+    std::vector<char> state;
+    REQUIRE( ws_.save_state(state) == true );
+    // header + 2 doubles + length-prefixed string
+    REQUIRE( state.size() == 16 + 16 + 8 + 10 );
+
+    A_->a_.set(-1);
+    B_->b_.set(-2);
+    B_->s_.set("overwritten");
+    REQUIRE( ws_.load_state(state) == true );
+    REQUIRE( A_->a_() == 0.5 );
+    REQUIRE( B_->b_() == 1.5 );
+    REQUIRE( B_->s_() == "checkpoint" );
+
+    // layout is rebuilt once the graph changes
+    auto* C_ = static_cast<A*>(ws_.new_proc("A"));
+    REQUIRE( ws_.load_state(state) == false );
+    C_->a_.set(2.5);
+    REQUIRE( ws_.save_state(state) == true );
+    C_->a_.set(0);
+    REQUIRE( ws_.load_state(state) == true );
+    REQUIRE( C_->a_() == 2.5 );
+
+    // truncated state
+    state.pop_back();
+    REQUIRE( ws_.load_state(state) == false );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    const size_t n = 100000;
+    for (size_t i = 0; i < n; i++)
+    {
+        ws_.new_proc("A");
+    }
+    std::vector<double> src(n), dst(n);
+    BENCHMARK("memcpy 100k doubles")
+    {
+        std::memcpy(dst.data(), src.data(), n * sizeof(double));
+        return dst[0];
+    };
+    BENCHMARK("Save state 100k procs")
+    {
+        return ws_.save_state(state);
+    };
+    BENCHMARK("Load state 100k procs")
+    {
+        return ws_.load_state(state);
+    };
+#endif
+
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+TEST_CASE("Workspace Packing...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Inc", ([](){return new Inc();}));
+    uvw::ws::reg_proc("B", ([](){return new B();}));
+    uvw::var::data_pull = true;
+
+    // chain of incrementers created in reverse of processing order
+    const size_t n = 1000;
+    uvw::ws ws_;
+    std::vector<Inc*> procs;
+    for (size_t i = 0; i < n; i++)
+    {
+        procs.push_back(static_cast<Inc*>(ws_.new_proc("Inc")));
+    }
+    for (size_t i = 1; i < n; i++)
+    {
+        procs[n - i - 1]->i_.link(&procs[n - i]->o_);
+    }
+    auto* B_ = static_cast<B*>(ws_.new_proc("B"));
+    B_->s_.set("unpacked");
+    REQUIRE( ws_.set_output(procs[0]->o_.key()) == true );
+    procs[n - 1]->i_.set(1);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[0]->o_() == 1 + n );
+
+    REQUIRE( ws_.packed() == false );
+    REQUIRE( ws_.pack() == true );
+    REQUIRE( ws_.packed() == true );
+
+    // values are kept & laid out contiguously in processing order
+    REQUIRE( procs[0]->o_() == 1 + n );
+    auto* first = (int64_t*)procs[n - 1]->i_.raw_data();
+    REQUIRE( (int64_t*)procs[n - 1]->o_.raw_data() == first + 1 );
+    REQUIRE( (int64_t*)procs[0]->o_.raw_data() == first + 2 * n - 1 );
+    REQUIRE( ((size_t)first) % 64 == 0 );
+
+    procs[n - 1]->i_.set(5);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[0]->o_() == 5 + n );
+
+    // packed state: int64 & double slabs + string codec
+    std::vector<char> state;
+    REQUIRE( ws_.save_state(state) == true );
+    REQUIRE( state.size() == 16 + 2 * n * 8 + 8 + 8 + 8 );
+    procs[n - 1]->i_.set(0);
+    REQUIRE( ws_.load_state(state) == true );
+    REQUIRE( procs[n - 1]->i_() == 5 );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    BENCHMARK("Process packed")
+    {
+        return ws_.process();
+    };
+    BENCHMARK("Save state packed")
+    {
+        return ws_.save_state(state);
+    };
+#endif
+
+    REQUIRE( ws_.unpack() == true );
+    REQUIRE( ws_.packed() == false );
+    REQUIRE( (int64_t*)procs[n - 1]->i_.raw_data() != first );
+    REQUIRE( procs[0]->o_() == 5 + n );
+    procs[n - 1]->i_.set(7);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[0]->o_() == 7 + n );
+    REQUIRE( B_->s_() == "unpacked" );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    BENCHMARK("Process unpacked")
+    {
+        return ws_.process();
+    };
+    BENCHMARK("Save state unpacked")
+    {
+        return ws_.save_state(state);
+    };
+#endif
+
+    // clearing a packed workspace restores per-var storage first
+    REQUIRE( ws_.pack() == true );
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+TEST_CASE("Workspace Indexes...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Inc", ([](){return new Inc();}));
+    uvw::ws::reg_proc("B", ([](){return new B();}));
+
+    const size_t n = 10000;
+    uvw::ws ws_;
+    for (size_t i = 0; i < n; i++)
+    {
+        ws_.new_proc(i % 2? "B" : "Inc");
+    }
+    REQUIRE( uvw::ws::procs().size() == n );
+    REQUIRE( uvw::ws::procs("Inc").size() == n / 2 );
+    REQUIRE( uvw::ws::procs("B").size() == n / 2 );
+    REQUIRE( uvw::ws::procs("A").empty() );
+    for (auto* proc_ptr : uvw::ws::procs("B"))
+    {
+        REQUIRE( proc_ptr->type_str() == "B" );
+    }
+
+    auto* B_ = ws_.proc_ptrs()[1];
+    REQUIRE( uvw::ws::vars().size() == 2 * n );
+    REQUIRE( uvw::ws::vars(B_).size() == 2 );
+    for (const auto& itr : uvw::ws::vars(B_))
+    {
+        REQUIRE( itr.second->proc() == B_ );
+        REQUIRE( itr.first == itr.second->key() );
+    }
+
+    // indexes follow de-registration
+    REQUIRE( uvw::ws::del(uvw::duo(B_, "s")) == true );
+    REQUIRE( uvw::ws::vars(B_).size() == 1 );
+    REQUIRE( uvw::ws::vars().size() == 2 * n - 1 );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    BENCHMARK("Vars by proc")
+    {
+        size_t res = 0;
+        for (const auto& itr : uvw::ws::vars(B_))
+        {
+            res += itr.first.var_str.size();
+        }
+        return res;
+    };
+    BENCHMARK("Procs by type")
+    {
+        return uvw::ws::procs("B").size();
+    };
+#endif
+
+    ws_.clear();
+    REQUIRE( uvw::ws::procs("B").size() == 0 );
+    REQUIRE( uvw::ws::vars(B_).size() == 0 );
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+// poolable procs
+struct PInc : Inc
+{
+    bool reset() override {i_.set(0); o_.set(0); return true;}
+};
+struct PA : A
+{
+    bool reset() override {a_.set(0); return true;}
+};
+
+// chain of n incrementers, or of vars linked sink first, either built in
+// bulk or linked one by one
+static std::vector<uvw::Processor*> build_chain(
+    uvw::ws& ws_,
+    size_t n,
+    bool bulk,
+    bool var_chain = false
+)
+{
+    std::vector<uvw::Processor*> procs;
+    std::unique_ptr<uvw::Builder> builder(
+        bulk? new uvw::Builder(ws_, n, n) : nullptr);
+    for (size_t i = 0; i < n; i++)
+    {
+        std::string type(var_chain? "PA" : "PInc");
+        procs.push_back(bulk? builder->add(type) : ws_.new_proc(type));
+    }
+    for (size_t i = n - 1; i > 0; i--)
+    {
+        auto src = uvw::duo(procs[i - 1], var_chain? "a" : "o");
+        auto dst = uvw::duo(procs[i], var_chain? "a" : "i");
+        bulk? builder->link(src, dst) : (void)uvw::ws::link(src, dst);
+    }
+    auto out = uvw::duo(procs[n - 1], var_chain? "a" : "o");
+    if (bulk)
+    {
+        builder->set_output(out);
+        builder->commit();
+    }
+    else
+    {
+        ws_.set_output(out);
+    }
+    return procs;
+}
+
+TEST_CASE("Workspace Builder...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("PInc", ([](){return new PInc();}));
+    uvw::ws::reg_proc("PA", ([](){return new PA();}));
+    uvw::ws::reg_proc("A", ([](){return new A();}));
+    uvw::var::data_pull = true;
+
+    const size_t n = 1000;
+    uvw::ws ws_;
+    std::vector<uvw::Processor*> procs;
+    {
+        uvw::Builder builder(ws_, n, n);
+        for (size_t i = 0; i < n; i++)
+        {
+            procs.push_back(builder.add("PInc"));
+        }
+        for (size_t i = 1; i < n; i++)
+        {
+            builder.link(uvw::duo(procs[i - 1], "o"), uvw::duo(procs[i], "i"));
+        }
+        builder.set_output(uvw::duo(procs[n - 1], "o"));
+
+        // links & schedule are deferred to the commit
+        REQUIRE( uvw::ws::links().size() == 0 );
+        REQUIRE( ws_.seq().size() == 0 );
+        REQUIRE( builder.commit() == true );
+    }
+    REQUIRE( uvw::ws::links().size() == n - 1 );
+    REQUIRE( ws_.seq().size() == n );
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->ref<int64_t>("o") == n );
+
+    // var chains linked sink first resolve to their head
+    {
+        uvw::Builder builder(ws_);
+        auto* a0 = builder.add("A");
+        auto* a1 = builder.add("A");
+        auto* a2 = builder.add("A");
+        builder.link(uvw::duo(a1, "a"), uvw::duo(a2, "a"));
+        builder.link(uvw::duo(a0, "a"), uvw::duo(a1, "a"));
+        REQUIRE( builder.commit() == true );
+        uvw::var::data_pull = false;
+        a0->ref<double>("a") = 3.0;
+        REQUIRE( static_cast<A*>(a2)->a_() == 3.0 );
+        uvw::var::data_pull = true;
+
+        // nothing is linked if any link is invalid
+        builder.link(uvw::duo(a0, "a"), uvw::duo(procs[1], "o"));
+        builder.link(uvw::duo(procs[0], "i"), uvw::duo(procs[1], "o"));
+        REQUIRE( builder.commit() == false );
+        REQUIRE( uvw::ws::links().size() == n + 1 );
+    }
+
+    ws_.clear();
+    REQUIRE( uvw::ws::links().size() == 0 );
+
+    // bulk & one-by-one chains match
+    procs = build_chain(ws_, n, false);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->ref<int64_t>("o") == n );
+    auto data = ws_.to_json();
+    ws_.clear();
+    procs = build_chain(ws_, n, true);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->ref<int64_t>("o") == n );
+    REQUIRE( ws_.to_json().get<json::object>()["procs"] ==
+        data.get<json::object>()["procs"] );
+    ws_.clear();
+
+    // var chains linked sink first resolve to their head either way
+    for (bool bulk : {false, true})
+    {
+        procs = build_chain(ws_, 100, bulk, true);
+        uvw::var::data_pull = false;
+        procs[0]->ref<double>("a") = 2.0;
+        REQUIRE( static_cast<A*>(procs[99])->a_() == 2.0 );
+        uvw::var::data_pull = true;
+        ws_.clear();
+    }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    // builds & clears are measured apart, each run on its own workspace
+    for (size_t m : {1000, 10000, 100000})
+    {
+        for (bool bulk : {true, false})
+        {
+            BENCHMARK_ADVANCED(std::string(bulk? "Bulk" : "Linked") +
+                " build " + std::to_string(m) + " procs")(
+                Catch::Benchmark::Chronometer meter)
+            {
+                std::vector<uvw::ws> wss(meter.runs());
+                meter.measure([&](int i) {build_chain(wss[i], m, bulk);});
+            };
+        }
+        BENCHMARK_ADVANCED("Clear " + std::to_string(m) + " procs")(
+            Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<uvw::ws> wss(meter.runs());
+            for (auto& w : wss)
+            {
+                build_chain(w, m, true);
+            }
+            meter.measure([&](int i) {wss[i].clear();});
+        };
+    }
+    // one propagation per link down the growing chain when linked
+    BENCHMARK("Bulk build 1000 var chain")
+    {
+        build_chain(ws_, 1000, true, true);
+        ws_.clear();
+    };
+    BENCHMARK("Linked build 1000 var chain")
+    {
+        build_chain(ws_, 1000, false, true);
+        ws_.clear();
+    };
+#endif
+
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+TEST_CASE("Workspace Link Resolution...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("A", ([](){return new A();}));
+    uvw::var::data_pull = false;
+
+    // var chain a[0] <- a[1] <- ... <- a[n-1], linked source first
+    const size_t n = 100;
+    uvw::ws ws_;
+    std::vector<A*> a;
+    for (size_t i = 0; i < n; i++)
+    {
+        a.push_back(static_cast<A*>(ws_.new_proc("A")));
+        a[i]->a_.set(i);
+    }
+    for (size_t i = 1; i < n; i++)
+    {
+        REQUIRE( a[i]->get("a")->link(a[i - 1]->get("a")) );
+    }
+    REQUIRE( a[n - 1]->a_() == 0 );
+    REQUIRE( a[n / 2]->a_() == 0 );
+
+    // re-linking mid chain re-points everything downstream
+    auto* head = static_cast<A*>(ws_.new_proc("A"));
+    head->a_.set(-1);
+    REQUIRE( a[n / 2]->get("a")->link(head->get("a")) );
+    REQUIRE( a[n - 1]->a_() == -1 );
+    REQUIRE( a[n / 2 - 1]->a_() == 0 );
+    REQUIRE( head->get("a")->link(a[n - 1]->get("a")) == true );
+    REQUIRE( head->get("a")->unlink() == true );
+
+    // unlinking mid chain makes it the new head
+    REQUIRE( a[n / 2]->get("a")->unlink() == true );
+    REQUIRE( a[n - 1]->a_() == n / 2 );
+    REQUIRE( a[n / 2 + 1]->a_() == n / 2 );
+    REQUIRE( a[1]->a_() == 0 );
+
+    // heads moved to external storage are followed downstream
+    double ext = 0;
+    a[n / 2]->a_.rebind(&ext);
+    REQUIRE( a[n - 1]->a_() == n / 2 );
+    ext = 42;
+    REQUIRE( a[n - 1]->a_() == 42 );
+    a[n / 2]->a_.rebind(nullptr);
+    REQUIRE( a[n - 1]->a_() == 42 );
+
+    // relinking to the former head
+    REQUIRE( a[n / 2]->get("a")->link(a[n / 2 - 1]->get("a")) );
+    REQUIRE( a[n - 1]->a_() == 0 );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    ws_.clear();
+    a.clear();
+    for (size_t i = 0; i < 10000; i++)
+    {
+        a.push_back(static_cast<A*>(ws_.new_proc("A")));
+        if (i)
+        {
+            a[i]->get("a")->link(a[i - 1]->get("a"));
+        }
+    }
+    BENCHMARK("Relink 10000 var chain")
+    {
+        a[5000]->get("a")->unlink();
+        return a[5000]->get("a")->link(a[4999]->get("a"));
+    };
+    BENCHMARK("Relink & resolve 10000 var chain")
+    {
+        a[5000]->get("a")->unlink();
+        a[5000]->get("a")->link(a[4999]->get("a"));
+        return a[9999]->a_();
+    };
+#endif
+
+    uvw::var::data_pull = true;
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+struct N : uvw::Processor
+{
+    uvw::Var<int64_t> u_, v_, w_;
+    uvw::Var<std::string> s_, t_;
+    bool initialize() override
+    {
+        return (
+            reg_var<int64_t>("u", u_) &&
+            reg_var<int64_t>("v", v_) &&
+            reg_var<int64_t>("w", w_) &&
+            reg_var<std::string>("s", s_) &&
+            reg_var<std::string>("t", t_)
+        );
+    }
+};
+
+// exposes pull plans
+struct PullWorkspace : uvw::Workspace
+{
+    size_t pull_ops(size_t index)
+    {
+        return pulls_.procs[index + 1] - pulls_.procs[index];
+    }
+    bool planned() const {return pulls_.stamp.valid();}
+};
+
+TEST_CASE("Workspace Pull Plans...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("N", ([](){return new N();}));
+    uvw::var::data_pull = true;
+
+    // short chain; schedule revisits shared upstream procs per link
+    const size_t n = 6;
+    PullWorkspace ws_;
+    std::vector<N*> procs;
+    for (size_t i = 0; i < n; i++)
+    {
+        procs.push_back(static_cast<N*>(ws_.new_proc("N")));
+        if (i)
+        {
+            for (auto label : {"u", "v", "w", "s", "t"})
+            {
+                REQUIRE( uvw::ws::link(
+                    uvw::duo(procs[i - 1], label), uvw::duo(procs[i], label)
+                ) );
+            }
+        }
+    }
+    REQUIRE( ws_.set_output(procs[n - 1]->u_.key()) == true );
+    REQUIRE( ws_.seq().front() == procs[0] );
+
+    procs[0]->u_.set(1);
+    procs[0]->v_.set(2);
+    procs[0]->w_.set(3);
+    procs[0]->s_.set("s");
+    procs[0]->t_.set("t");
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->u_() == 1 );
+    REQUIRE( procs[n - 1]->w_() == 3 );
+    REQUIRE( procs[n - 1]->t_() == "t" );
+
+    // a raw copy group of int64 & a typed string loop per linked proc
+    REQUIRE( ws_.pull_ops(0) == 0 );
+    REQUIRE( ws_.pull_ops(1) == 2 );
+
+    // packed int64 values are copied as a single run
+    REQUIRE( ws_.pack() == true );
+    procs[0]->v_.set(4);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->v_() == 4 );
+    REQUIRE( ws_.pull_ops(1) == 2 );
+
+    // links changed between frames are re-planned
+    REQUIRE( procs[n / 2]->u_.link(&procs[0]->w_) );
+    REQUIRE( procs[n / 2]->s_.unlink() );
+    procs[n / 2]->s_.set("x");
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->u_() == 3 );
+    REQUIRE( procs[n - 1]->v_() == 4 );
+    REQUIRE( procs[n - 1]->s_() == "x" );
+    REQUIRE( procs[n / 2 - 1]->s_() == "s" );
+    REQUIRE( ws_.pull_ops(n / 2) == 3 );
+
+    // unpacked storage
+    REQUIRE( ws_.unpack() == true );
+    procs[0]->w_.set(5);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( procs[n - 1]->u_() == 5 );
+    REQUIRE( procs[n - 1]->w_() == 5 );
+
+    // links made in other workspaces leave the plan as is
+    {
+        uvw::ws other;
+        auto* x = other.new_proc("N");
+        auto* y = other.new_proc("N");
+        REQUIRE( ws_.planned() == true );
+        REQUIRE( uvw::ws::link(uvw::duo(x, "u"), uvw::duo(y, "u")) );
+        REQUIRE( ws_.planned() == true );
+        REQUIRE( procs[n / 2]->s_.link(&procs[0]->s_) );
+        REQUIRE( ws_.planned() == false );
+    }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    ws_.pack();
+    BENCHMARK("Process pull plan")
+    {
+        return ws_.process();
+    };
+    BENCHMARK("Execute per-var pulls")
+    {
+        return uvw::ws::execute(ws_.seq());
+    };
+#endif
+
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+struct Add : uvw::Processor
+{
+    uvw::Var<int64_t> i_, j_, o_;
+    bool initialize() override
+    {
+        return (
+            reg_var<int64_t>("i", i_) &&
+            reg_var<int64_t>("j", j_) &&
+            reg_var<int64_t>("o", o_)
+        );
+    }
+    bool process(bool preprocess) override
+    {
+        o_() = i_() + j_();
+        return true;
+    }
+};
+
+TEST_CASE("Workspace Pruning...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Inc", ([](){return new Inc();}));
+    uvw::ws::reg_proc("Add", ([](){return new Add();}));
+    uvw::var::data_pull = true;
+
+    // o = head + branch, with branch = head + 2 through x1 & x2
+    uvw::ws ws_;
+    auto* head = static_cast<Inc*>(ws_.new_proc("Inc"));
+    auto* x1 = static_cast<Inc*>(ws_.new_proc("Inc"));
+    auto* x2 = static_cast<Inc*>(ws_.new_proc("Inc"));
+    auto* add = static_cast<Add*>(ws_.new_proc("Add"));
+    x1->i_.link(&head->o_);
+    x2->i_.link(&x1->o_);
+    add->i_.link(&head->o_);
+    add->j_.link(&x2->o_);
+    REQUIRE( ws_.set_output(add->o_.key()) == true );
+
+    head->i_.set(0);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 0 );
+    REQUIRE( add->o_() == 4 );
+
+    // the branch only feeds a disabled input
+    add->j_.set_enabled(false);
+    head->i_.set(10);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 2 );
+    REQUIRE( x2->o_() == 3 );
+    REQUIRE( add->o_() == 14 );
+    for (size_t i = 0; i < ws_.seq().size(); i++)
+    {
+        auto* proc = ws_.seq()[i];
+        REQUIRE( ws_.pruned(i) == (proc == x1 || proc == x2) );
+    }
+
+    // re-enabled incrementally
+    add->j_.set_enabled(true);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 0 );
+    REQUIRE( add->o_() == 24 );
+
+    // a disabled output prunes its proc & the procs only feeding it
+    x2->o_.set_enabled(false);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 2 );
+    x1->o_.set_enabled(false);
+    x2->o_.set_enabled(true);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 1 );
+    x1->o_.set_enabled(true);
+
+    // preprocessing runs disabled branches
+    add->j_.set_enabled(false);
+    head->i_.set(20);
+    REQUIRE( ws_.process(true) == true );
+    REQUIRE( x2->o_() == 23 );
+    REQUIRE( add->o_() == 44 );
+
+    // through deltas & re-planned on link changes
+    json::object var_obj;
+    var_obj["index"] = json((int64_t)3);
+    var_obj["label"] = json(std::string("j"));
+    var_obj["enabled"] = json(true);
+    json::object delta_obj;
+    delta_obj["vars"] = json(json::array{json(var_obj)});
+    json delta(delta_obj);
+    REQUIRE( ws_.apply_delta(delta) == true );
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 0 );
+    add->j_.set_enabled(false);
+    add->j_.link(&x1->o_);
+    x2->i_.unlink();
+    REQUIRE( ws_.set_output(add->o_.key()) == true );
+    REQUIRE( ws_.process() == true );
+    REQUIRE( ws_.pruned() == 1 );
+
+    // within fused steps as well
+    REQUIRE( ws_.fuse() == true );
+    head->i_.set(30);
+    REQUIRE( ws_.process() == true );
+    REQUIRE( x1->o_() == 22 );
+    REQUIRE( add->o_() == 53 );
+    ws_.unfuse();
+
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
+
+TEST_CASE("Workspace Push...", "[ws]")
+{
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+    REQUIRE( uvw::ws::workspaces().size() == 0 );
+
+    uvw::ws::reg_proc("Inc", ([](){return new Inc();}));
+    uvw::ws::reg_proc("Add", ([](){return new Add();}));
+    uvw::var::data_pull = true;
+
+    // tail = (head + pre) + 1; side is unrelated
+    uvw::ws ws_;
+    auto* head = static_cast<Inc*>(ws_.new_proc("Inc"));
+    auto* pre = static_cast<Inc*>(ws_.new_proc("Inc"));
+    auto* add = static_cast<Add*>(ws_.new_proc("Add"));
+    auto* tail = static_cast<Inc*>(ws_.new_proc("Inc"));
+    auto* side = static_cast<Inc*>(ws_.new_proc("Inc"));
+    add->i_.link(&head->o_);
+    add->j_.link(&pre->o_);
+    tail->i_.link(&add->o_);
+    pre->i_.set(5);
+
+    // subscriptions fire on changed values only
+    std::vector<int64_t> seen;
+    size_t id = add->o_.subscribe([&](uvw::Variable* v)
+        {
+            seen.push_back(static_cast<uvw::Var<int64_t>*>(v)->get());
+        }
+    );
+    REQUIRE( id > 0 );
+    REQUIRE( add->o_.subscribed() == true );
+    uvw::Var<int64_t> loose;
+    REQUIRE( loose.subscribe([](uvw::Variable*){}) == 0 );
+
+    // only the written var's proc & its downstream are processed
+    head->i_.set(1);
+    REQUIRE( head->i_.push() == true );
+    REQUIRE( tail->o_() == 3 );
+    REQUIRE( pre->o_() == 0 );
+    REQUIRE( side->o_() == 0 );
+    REQUIRE( seen == std::vector<int64_t>({2}) );
+    REQUIRE( head->i_.push() == true );
+    REQUIRE( seen.size() == 1 );
+
+    // & on processing as well
+    REQUIRE( ws_.set_output(tail->o_.key()) == true );
+    REQUIRE( ws_.process() == true );
+    REQUIRE( seen == std::vector<int64_t>({2, 8}) );
+
+    // one-shot subscriptions unsubscribe while firing
+    size_t once = 0, once_id = 0;
+    once_id = add->o_.subscribe([&](uvw::Variable* v)
+        {
+            once++;
+            v->unsubscribe(once_id);
+        }
+    );
+    head->i_.set(2);
+    REQUIRE( uvw::ws::push(head->i_.key()) == true );
+    head->i_.set(3);
+    REQUIRE( uvw::ws::push(head->i_.key()) == true );
+    REQUIRE( once == 1 );
+    REQUIRE( seen == std::vector<int64_t>({2, 8, 9, 10}) );
+    REQUIRE( add->o_.unsubscribe(once_id) == false );
+    REQUIRE( add->o_.unsubscribe(id) == true );
+    REQUIRE( add->o_.subscribed() == false );
+    head->i_.set(4);
+    REQUIRE( head->i_.push() == true );
+    REQUIRE( seen.size() == 4 );
+
+    // values written outside of procs are seen through notify
+    size_t writes = 0;
+    head->i_.subscribe([&](uvw::Variable*){writes++;});
+    REQUIRE( head->i_.notify() == false );
+    head->i_.set(7);
+    REQUIRE( head->i_.notify() == true );
+    REQUIRE( head->i_.notify() == false );
+    head->i_.set(8);
+    REQUIRE( head->i_.push() == true );
+    REQUIRE( writes == 2 );
+
+    // re-planned on link changes; cyclic links fail
+    side->i_.link(&tail->o_);
+    REQUIRE( head->i_.push() == true );
+    REQUIRE( tail->o_() == 16 );
+    REQUIRE( side->o_() == 17 );
+    head->i_.link(&side->o_);
+    REQUIRE( head->i_.push() == false );
+    head->i_.unlink();
+    REQUIRE( head->i_.push() == true );
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+    // a long chain with the input near its end
+    std::vector<Inc*> chain;
+    for (int i = 0; i < 1000; i++)
+    {
+        chain.push_back(static_cast<Inc*>(ws_.new_proc("Inc")));
+        if (i)
+        {
+            chain[i]->i_.link(&chain[i - 1]->o_);
+        }
+    }
+    std::vector<uvw::Processor*> seq(chain.begin(), chain.end());
+    BENCHMARK("Process 1000 procs")
+    {
+        return uvw::ws::execute(seq);
+    };
+    BENCHMARK("Push 10 of 1000 procs")
+    {
+        return chain[990]->i_.push();
+    };
+#endif
+
+    ws_.clear();
+    REQUIRE( uvw::ws::procs().size() == 0 );
+    REQUIRE( uvw::ws::links().size() == 0 );
+    REQUIRE( uvw::ws::vars().size() == 0 );
+}
@@ -0,0 +1,431 @@
+// uvw_bench_io: serialization throughput over a generated workspace corpus
+//
+//   uvw_bench_io [case]... [-o corpus dir] [-t min seconds per op]
+//
+// generates workspace documents from tiny to multi-hundred-MB (see cases
+// below; deterministic per case), then times json save (to_json, to_str),
+// json load (parse, from_json, from_str, Processor::from_json) & binary
+// state I/O (save_state, load_state) on each. reports MB/s of the document
+// (or state buffer), allocations & bytes allocated per op, & the peak RSS
+// growth during the op. with -o the documents are written as <case>.json,
+// so other formats can be measured against the same corpus. cases default
+// to all but "huge"
+
+#include <uvw.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// allocation counters
+
+static std::atomic<uint64_t> alloc_count(0);
+static std::atomic<uint64_t> alloc_bytes(0);
+
+// out of line, so inlined deletes do not pair free with operator new
+// (-Wmismatched-new-delete)
+__attribute__((noinline)) static void release(void* ptr) {std::free(ptr);}
+
+void* operator new(size_t size)
+{
+  alloc_count++;
+  alloc_bytes += size;
+  void* ptr = std::malloc(size? size : 1);
+  if (!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+void operator delete(void* ptr) noexcept {release(ptr);}
+void operator delete(void* ptr, size_t) noexcept {release(ptr);}
+
+#ifdef __cpp_aligned_new
+// aligned storage, e.g. of Array values
+void* operator new(size_t size, std::align_val_t align)
+{
+  alloc_count++;
+  alloc_bytes += size;
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, std::max(sizeof(void*), (size_t)align),
+        size? size : 1))
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {release(ptr);}
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+  release(ptr);
+}
+#endif
+
+// resident set size in MB, current & peak since the last reset
+
+static double rss_mb(const char* field)
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, std::strlen(field), field) == 0)
+    {
+      return std::strtod(line.c_str() + std::strlen(field), nullptr) / 1024;
+    }
+  }
+  return 0;
+}
+
+static void reset_peak()
+{
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+// corpus
+
+struct Case
+{
+  std::string name;
+  size_t procs;
+  size_t vars;
+  // fraction of vars with enums & with values (min/max/default)
+  double enums;
+  double values;
+  // links per proc
+  double links;
+};
+
+static const std::vector<Case> cases = {
+  {"tiny", 10, 4, 0.25, 0.25, 1},
+  {"small", 1000, 8, 0.1, 0.5, 1},
+  {"medium", 10000, 16, 0.1, 0.5, 1},
+  {"enums", 10000, 16, 1, 0, 1},
+  {"values", 10000, 16, 0, 1, 1},
+  {"links", 20000, 8, 0, 0, 4},
+  {"wide", 1000, 256, 0.1, 0.5, 16},
+  {"large", 100000, 16, 0.1, 0.5, 1},
+  {"huge", 250000, 24, 0.1, 0.5, 2}
+};
+
+// vars of mixed types: double, int64, string & bool by label index
+struct Bench : uvw::Processor
+{
+  static size_t n_vars;
+
+  std::deque<uvw::Var<double> > d_;
+  std::deque<uvw::Var<int64_t> > i_;
+  std::deque<uvw::Var<std::string> > s_;
+  std::deque<uvw::Var<bool> > b_;
+
+  bool initialize() override
+  {
+    bool res = true;
+    for (size_t k = 0; k < n_vars && res; k++)
+    {
+      std::string label = "v" + std::to_string(k);
+      switch (k % 4)
+      {
+        case 0: d_.emplace_back(); res = reg_var(label, d_.back()); break;
+        case 1: i_.emplace_back(); res = reg_var(label, i_.back()); break;
+        case 2: s_.emplace_back(); res = reg_var(label, s_.back()); break;
+        default: b_.emplace_back(); res = reg_var(label, b_.back()); break;
+      }
+    }
+    return res;
+  }
+};
+size_t Bench::n_vars = 0;
+
+static std::string random_str(std::mt19937_64& rng)
+{
+  static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+  std::string str(8 + rng() % 25, ' ');
+  for (auto& c : str)
+  {
+    c = chars[rng() % (sizeof(chars) - 1)];
+  }
+  return str;
+}
+
+template<typename T>
+static void fill(uvw::Var<T>& v, const Case& c, std::mt19937_64& rng,
+  const std::function<T()>& gen)
+{
+  std::uniform_real_distribution<double> u(0, 1);
+  v.set(gen());
+  if (u(rng) < c.enums)
+  {
+    for (int e = 0; e < 3; e++)
+    {
+      v.enums.push_back({"Item" + std::to_string(e), gen()});
+    }
+  }
+  if (u(rng) < c.values)
+  {
+    v.values["min"] = gen();
+    v.values["max"] = gen();
+    v.values["default"] = gen();
+  }
+}
+
+static void generate(const Case& c, uvw::Workspace& ws)
+{
+  std::mt19937_64 rng(std::hash<std::string>()(c.name));
+  std::uniform_real_distribution<double> u(-1e3, 1e3);
+  Bench::n_vars = c.vars;
+
+  std::vector<Bench*> procs;
+  for (size_t p = 0; p < c.procs; p++)
+  {
+    auto* proc = static_cast<Bench*>(ws.new_proc("Bench"));
+    for (auto& v : proc->d_)
+    {
+      fill<double>(v, c, rng, [&](){return u(rng);});
+    }
+    for (auto& v : proc->i_)
+    {
+      fill<int64_t>(v, c, rng, [&](){return (int64_t)(rng() >> 16);});
+    }
+    for (auto& v : proc->s_)
+    {
+      fill<std::string>(v, c, rng, [&](){return random_str(rng);});
+    }
+    for (auto& v : proc->b_)
+    {
+      fill<bool>(v, c, rng, [&](){return (bool)(rng() & 1);});
+    }
+    procs.push_back(proc);
+  }
+
+  // link vars of the first half to the same labels of earlier procs
+  size_t n_links = c.procs * c.links;
+  size_t inputs = std::max<size_t>(c.vars / 2, 1);
+  for (size_t l = 0; l < n_links && c.procs > 1; l++)
+  {
+    size_t dst = 1 + l % (c.procs - 1);
+    size_t src = rng() % dst;
+    std::string label = "v" + std::to_string((l / (c.procs - 1)) % inputs);
+    uvw::ws::link(uvw::duo(procs[src], label), uvw::duo(procs[dst], label));
+  }
+}
+
+// measurements
+
+struct Result
+{
+  double secs = 0;
+  size_t runs = 0;
+  uint64_t allocs = 0;
+  uint64_t alloc_bytes = 0;
+  double peak_mb = 0;
+};
+
+static double min_secs = 0.2;
+
+// run op (after setup, before cleanup) until min_secs elapsed; counters are
+// of the first run
+static Result measure(const std::function<void()>& op,
+  const std::function<void()>& setup = nullptr,
+  const std::function<void()>& cleanup = nullptr)
+{
+  using Clock = std::chrono::steady_clock;
+  Result res;
+  while (res.runs == 0 || res.secs < min_secs)
+  {
+    if (setup)
+    {
+      setup();
+    }
+    bool first = (res.runs == 0);
+    double rss = 0;
+    uint64_t count = alloc_count, bytes = alloc_bytes;
+    if (first)
+    {
+      reset_peak();
+      rss = rss_mb("VmRSS:");
+    }
+    auto t0 = Clock::now();
+    op();
+    res.secs += std::chrono::duration<double>(Clock::now() - t0).count();
+    if (first)
+    {
+      res.allocs = alloc_count - count;
+      res.alloc_bytes = alloc_bytes - bytes;
+      res.peak_mb = std::max(0.0, rss_mb("VmHWM:") - rss);
+    }
+    res.runs++;
+    if (cleanup)
+    {
+      cleanup();
+    }
+  }
+  return res;
+}
+
+static void report(const Case& c, const std::string& op, double mb,
+  const Result& r)
+{
+  double secs = r.secs / r.runs;
+  std::cout << std::left << std::setw(8) << c.name << std::setw(14) << op <<
+    std::right << std::fixed << std::setprecision(2) <<
+    std::setw(10) << mb << " MB" <<
+    std::setw(11) << secs * 1e3 << " ms" <<
+    std::setw(10) << mb / secs << " MB/s" <<
+    std::setw(12) << r.allocs << " allocs" <<
+    std::setw(10) << r.alloc_bytes / 1048576.0 << " MB alloc" <<
+    std::setw(10) << r.peak_mb << " MB peak" << std::endl;
+}
+
+static bool run(const Case& c, const std::string& dir)
+{
+  uvw::Workspace ws;
+  generate(c, ws);
+  std::string doc = ws.to_str();
+  double mb = doc.size() / 1048576.0;
+  std::cout << "# " << c.name << ": " << c.procs << " procs, " << c.vars <<
+    " vars/proc, " << uvw::ws::links().size() << " links, enums " <<
+    c.enums << ", values " << c.values << std::endl;
+  if (!dir.empty())
+  {
+    std::ofstream file(dir + "/" + c.name + ".json");
+    file << doc;
+    if (!file)
+    {
+      std::cerr << "Cannot write corpus to '" << dir << "'!" << std::endl;
+      return false;
+    }
+  }
+
+  // json save
+  json data;
+  report(c, "to_json", mb, measure([&](){data = ws.to_json();}));
+  std::string str;
+  report(c, "serialize", mb, measure([&](){str = data.serialize();}));
+  report(c, "to_str", mb, measure([&](){str = ws.to_str();}));
+  data = json();
+  str.clear();
+
+  // json load
+  report(c, "parse", mb, measure(
+    [&](){picojson::parse(data, doc);},
+    nullptr,
+    [&](){data = json();}
+  ));
+
+  bool ok = true;
+  uvw::Workspace other;
+  report(c, "from_json", mb, measure(
+    [&](){ok = other.from_json(data) && ok;},
+    [&](){picojson::parse(data, doc);},
+    [&](){other.clear(); data = json();}
+  ));
+  report(c, "from_str", mb, measure(
+    [&](){ok = other.from_str(doc) && ok;},
+    nullptr,
+    [&](){other.clear();}
+  ));
+
+  // proc states only, into existing procs
+  picojson::parse(data, doc);
+  auto& procs = data.get<json::object>()["procs"].get<json::array>();
+  report(c, "proc_from_json", mb, measure([&]()
+    {
+      for (size_t p = 0; p < procs.size(); p++)
+      {
+        ok = ws.proc_ptrs()[p]->from_json(procs[p]) && ok;
+      }
+    }
+  ));
+  data = json();
+
+  // binary states
+  std::vector<char> state;
+  ws.save_state(state);
+  double state_mb = state.size() / 1048576.0;
+  report(c, "save_state", state_mb, measure([&](){ws.save_state(state);}));
+  report(c, "load_state", state_mb, measure(
+    [&](){ok = ws.load_state(state) && ok;}));
+
+  ws.clear();
+  if (!ok)
+  {
+    std::cerr << "Failure: loading " << c.name << " failed!" << std::endl;
+  }
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<const Case*> selected;
+  std::string dir;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if ((arg == "-o" || arg == "-t") && i + 1 < argc)
+    {
+      if (arg == "-o")
+      {
+        dir = argv[++i];
+      }
+      else
+      {
+        min_secs = std::strtod(argv[++i], nullptr);
+      }
+      continue;
+    }
+    const Case* found = nullptr;
+    for (const auto& c : cases)
+    {
+      found = (c.name == arg)? &c : found;
+    }
+    if (!found)
+    {
+      std::cerr << "usage: uvw_bench_io [case]... [-o corpus dir] " <<
+        "[-t min seconds per op]\ncases:";
+      for (const auto& c : cases)
+      {
+        std::cerr << " " << c.name;
+      }
+      std::cerr << std::endl;
+      return 1;
+    }
+    selected.push_back(found);
+  }
+  if (selected.empty())
+  {
+    for (const auto& c : cases)
+    {
+      if (c.name != "huge")
+      {
+        selected.push_back(&c);
+      }
+    }
+  }
+
+  uvw::ws::reg_proc("Bench", [](){return new Bench();});
+  bool res = true;
+  for (const auto* c : selected)
+  {
+    res = run(*c, dir) && res;
+  }
+  return res? 0 : 1;
+}
@@ -0,0 +1,465 @@
+// uvw_gen: ahead-of-time code generation from a serialized workspace
+//
+//   uvw_gen <workspace.json> <output base> [-n class name]
+//     [-i include]... [-t proc type=C++ class]... [-v var type=C++ type]...
+//
+// emits <output base>.h & <output base>.cpp declaring a class that holds the
+// workspace procs by value, links vars through typed pointers resolved once
+// on construction & processes procs in scheduled order with non-virtual
+// calls; proc types default to C++ classes of the same name
+
+#include <picojson.h>
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using json = picojson::value;
+
+struct GenLink
+{
+  int64_t src, dst;
+  std::string src_label, dst_label;
+  std::string type;
+};
+
+struct GenVar
+{
+  int64_t index;
+  std::string label;
+  std::string type;
+};
+
+struct Generator
+{
+  std::string name;
+  std::string source;
+  std::vector<std::string> includes;
+  std::map<std::string, std::string> proc_types;
+  std::map<std::string, std::string> var_types = {
+    {"int64", "int64_t"},
+    {"bool", "bool"},
+    {"double", "double"},
+    {"string", "std::string"}
+  };
+
+  std::vector<std::string> procs;
+  std::vector<std::map<std::string, std::string> > vars;
+  std::vector<GenLink> links;
+  std::vector<int64_t> seq;
+  GenVar in, out;
+
+  bool load(json& data);
+  bool schedule();
+  bool write(const std::string& base);
+
+  std::string class_of(int64_t index);
+  bool find_var(json& data, GenVar& var);
+};
+
+std::string Generator::class_of(int64_t index)
+{
+  auto itr = proc_types.find(procs[index]);
+  return (itr == proc_types.end())? procs[index] : itr->second;
+}
+
+bool Generator::find_var(json& data, GenVar& var)
+{
+  auto& var_obj = data.get<picojson::object>();
+  var.index = var_obj["index"].get<int64_t>();
+  var.label = var_obj["label"].get<std::string>();
+  if (var.index < 0 || var.index >= (int64_t)procs.size() ||
+        vars[var.index].find(var.label) == vars[var.index].end())
+  {
+    std::cerr << "Cannot find var '" << var.label << "' of proc index " <<
+      var.index << "!" << std::endl;
+    return false;
+  }
+  auto& type = vars[var.index][var.label];
+  if (var_types.find(type) == var_types.end())
+  {
+    std::cerr << "Unknown var type '" << type << "'!" << std::endl;
+    return false;
+  }
+  var.type = var_types[type];
+  return true;
+}
+
+bool Generator::load(json& data)
+{
+  if (!data.is<picojson::object>())
+  {
+    std::cerr << "Invalid workspace json!" << std::endl;
+    return false;
+  }
+  auto& data_obj = data.get<picojson::object>();
+
+  if (data_obj.find("procs") != data_obj.end() &&
+        data_obj["procs"].is<picojson::array>())
+  {
+    for (auto& proc_itr : data_obj["procs"].get<picojson::array>())
+    {
+      auto& proc_obj = proc_itr.get<picojson::object>();
+      procs.push_back(proc_obj["type"].get<std::string>());
+      vars.push_back({});
+      if (proc_obj.find("vars") == proc_obj.end())
+      {
+        continue;
+      }
+      for (auto& var_itr : proc_obj["vars"].get<picojson::array>())
+      {
+        auto& var_obj = var_itr.get<picojson::object>();
+        vars.back()[var_obj["label"].get<std::string>()] =
+          var_obj["type"].get<std::string>();
+      }
+    }
+  }
+  if (!procs.size())
+  {
+    std::cerr << "No procs found!" << std::endl;
+    return false;
+  }
+
+  if (data_obj.find("links") != data_obj.end() &&
+        data_obj["links"].is<picojson::array>())
+  {
+    for (auto& link_itr : data_obj["links"].get<picojson::array>())
+    {
+      auto& link_obj = link_itr.get<picojson::object>();
+      GenVar src, dst;
+      if (!find_var(link_obj["src"], src) || !find_var(link_obj["var"], dst))
+      {
+        return false;
+      }
+      if (src.type != dst.type)
+      {
+        std::cerr << "Mismatched link types '" << src.type << "' & '" <<
+          dst.type << "'!" << std::endl;
+        return false;
+      }
+      links.push_back({src.index, dst.index, src.label, dst.label, src.type});
+    }
+  }
+
+  in.index = out.index = -1;
+  if (data_obj.find("in") != data_obj.end() && !find_var(data_obj["in"], in))
+  {
+    return false;
+  }
+  if (data_obj.find("out") != data_obj.end() && !find_var(data_obj["out"], out))
+  {
+    return false;
+  }
+  return schedule();
+}
+
+bool Generator::schedule()
+{
+  // upstream procs of the output, or all procs if there is no output
+  std::set<int64_t> scope;
+  if (out.index < 0)
+  {
+    for (int64_t i = 0; i < (int64_t)procs.size(); i++)
+    {
+      scope.insert(i);
+    }
+  }
+  else
+  {
+    std::queue<int64_t> proc_queue;
+    proc_queue.push(out.index);
+    scope.insert(out.index);
+    while (proc_queue.size())
+    {
+      int64_t index = proc_queue.front();
+      proc_queue.pop();
+      for (const auto& lk : links)
+      {
+        if (lk.dst == index && scope.insert(lk.src).second)
+        {
+          proc_queue.push(lk.src);
+        }
+      }
+    }
+  }
+
+  // topological order, ties broken by proc index
+  std::map<int64_t, size_t> n_srcs;
+  for (auto index : scope)
+  {
+    n_srcs[index] = 0;
+  }
+  for (const auto& lk : links)
+  {
+    if (lk.src != lk.dst && scope.count(lk.src) && scope.count(lk.dst))
+    {
+      n_srcs[lk.dst]++;
+    }
+  }
+  std::set<int64_t> ready;
+  for (const auto& itr : n_srcs)
+  {
+    if (!itr.second)
+    {
+      ready.insert(itr.first);
+    }
+  }
+  while (ready.size())
+  {
+    int64_t index = *ready.begin();
+    ready.erase(ready.begin());
+    seq.push_back(index);
+    for (const auto& lk : links)
+    {
+      if (lk.src == index && lk.dst != index && scope.count(lk.dst) &&
+            --n_srcs[lk.dst] == 0)
+      {
+        ready.insert(lk.dst);
+      }
+    }
+  }
+  if (seq.size() != scope.size())
+  {
+    std::cerr << "Cyclic links found!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Generator::write(const std::string& base)
+{
+  if (source.find(")uvw\"") != std::string::npos)
+  {
+    std::cerr << "Cannot embed workspace json!" << std::endl;
+    return false;
+  }
+
+  std::string guard("UVW_GEN_");
+  for (char c : name)
+  {
+    guard += std::isalnum((unsigned char)c)? (char)std::toupper(c) : '_';
+  }
+  guard += "_H";
+
+  std::ostringstream h;
+  h << "// generated by uvw_gen; do not edit\n";
+  h << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+  h << "#include <uvw.h>\n";
+  for (const auto& inc : includes)
+  {
+    h << "#include \"" << inc << "\"\n";
+  }
+  h << "\n#include <array>\n\n\n";
+  h << "class " << name << "\n{\n";
+  h << "  public:\n\n";
+  h << "  static const size_t size = " << procs.size() << ";\n\n";
+  h << "  " << name << "();\n";
+  h << "  ~" << name << "();\n";
+  h << "  " << name << "(const " << name << "&) = delete;\n";
+  h << "  " << name << "& operator=(const " << name << "&) = delete;\n\n";
+  h << "  bool valid() const {return valid_;}\n";
+  h << "  bool process(bool preprocess = false);\n\n";
+  for (size_t i = 0; i < procs.size(); i++)
+  {
+    h << "  " << class_of(i) << "& proc_" << i << "() {return p" << i <<
+      "_;}\n";
+  }
+  h << "  const std::array<uvw::Processor*, size>& proc_ptrs() const" <<
+    " {return proc_ptrs_;}\n";
+  if (in.index >= 0)
+  {
+    h << "  " << in.type << "& in() {return *in_;}\n";
+  }
+  if (out.index >= 0)
+  {
+    h << "  " << out.type << "& out() {return *out_;}\n";
+  }
+  h << "\n  // workspace json the class was generated from\n";
+  h << "  static const char* source();\n\n";
+  h << "  protected:\n\n";
+  for (size_t i = 0; i < procs.size(); i++)
+  {
+    h << "  " << class_of(i) << " p" << i << "_;\n";
+  }
+  h << "  std::array<uvw::Processor*, size> proc_ptrs_;\n";
+  if (links.size())
+  {
+    h << "\n  // links as typed pointers into var storage\n";
+  }
+  for (size_t i = 0; i < links.size(); i++)
+  {
+    h << "  " << links[i].type << "* dst_" << i << "_;\n";
+    h << "  const " << links[i].type << "* src_" << i << "_;\n";
+  }
+  if (in.index >= 0)
+  {
+    h << "  " << in.type << "* in_;\n";
+  }
+  if (out.index >= 0)
+  {
+    h << "  " << out.type << "* out_;\n";
+  }
+  h << "  bool valid_;\n";
+  h << "};\n\n#endif\n";
+
+  std::string header = base + ".h";
+  auto slash = header.find_last_of("/\\");
+  std::ostringstream c;
+  c << "// generated by uvw_gen; do not edit\n";
+  c << "#include \"" <<
+    (slash == std::string::npos? header : header.substr(slash + 1)) <<
+    "\"\n\n";
+  c << "namespace\n{\n";
+  c << "  template<typename T>\n";
+  c << "  T* resolve_(uvw::Processor& proc, const char* label)\n  {\n";
+  c << "    auto* v = proc.get(label);\n";
+  c << "    return (v && v->is_of_type<T>())? (T*)v->raw_data() : nullptr;\n";
+  c << "  }\n};\n\n";
+
+  c << "const size_t " << name << "::size;\n\n";
+  c << "const char* " << name << "::source()\n{\n";
+  c << "  return R\"uvw(" << source << ")uvw\";\n}\n\n";
+
+  c << name << "::" << name << "():\n  proc_ptrs_({{";
+  for (size_t i = 0; i < procs.size(); i++)
+  {
+    c << (i? ", " : "") << "&p" << i << "_";
+  }
+  c << "}}),\n  valid_(true)\n{\n";
+  c << "  for (auto* proc_ptr : proc_ptrs_)\n  {\n";
+  c << "    valid_ = proc_ptr->initialize() && valid_;\n  }\n\n";
+  c << "  // var states\n";
+  c << "  json data;\n";
+  c << "  if (valid_ && picojson::parse(data, source()).empty())\n  {\n";
+  c << "    auto& proc_list = data.get<json::object>()[\"procs\"]" <<
+    ".get<json::array>();\n";
+  c << "    for (size_t i = 0; i < size && valid_; i++)\n    {\n";
+  c << "      valid_ = proc_ptrs_[i]->from_json(proc_list[i]);\n    }\n";
+  c << "  }\n\n";
+  for (size_t i = 0; i < links.size(); i++)
+  {
+    const auto& lk = links[i];
+    c << "  dst_" << i << "_ = resolve_<" << lk.type << ">(p" << lk.dst <<
+      "_, \"" << lk.dst_label << "\");\n";
+    c << "  src_" << i << "_ = resolve_<" << lk.type << ">(p" << lk.src <<
+      "_, \"" << lk.src_label << "\");\n";
+    c << "  valid_ = valid_ && dst_" << i << "_ && src_" << i << "_ &&\n";
+    c << "    p" << lk.dst << "_.get(\"" << lk.dst_label << "\")->link(p" <<
+      lk.src << "_.get(\"" << lk.src_label << "\"));\n";
+  }
+  if (in.index >= 0)
+  {
+    c << "  in_ = resolve_<" << in.type << ">(p" << in.index << "_, \"" <<
+      in.label << "\");\n";
+    c << "  valid_ = valid_ && in_;\n";
+  }
+  if (out.index >= 0)
+  {
+    c << "  out_ = resolve_<" << out.type << ">(p" << out.index << "_, \"" <<
+      out.label << "\");\n";
+    c << "  valid_ = valid_ && out_;\n";
+  }
+  c << "}\n\n";
+
+  c << name << "::~" << name << "()\n{\n";
+  c << "  // de-register vars before the var members are destroyed\n";
+  c << "  for (auto* proc_ptr : proc_ptrs_)\n  {\n";
+  c << "    for (const auto& key : proc_ptr->var_keys())\n    {\n";
+  c << "      uvw::Workspace::del(key);\n    }\n  }\n}\n\n";
+
+  c << "bool " << name << "::process(bool preprocess)\n{\n";
+  c << "  if (!valid_)\n  {\n    return false;\n  }\n";
+  for (auto index : seq)
+  {
+    auto proc_class = class_of(index);
+    c << "\n  // [" << index << "] " << procs[index] << "\n";
+    for (size_t i = 0; i < links.size(); i++)
+    {
+      if (links[i].dst == index)
+      {
+        c << "  *dst_" << i << "_ = *src_" << i << "_;\n";
+      }
+    }
+    c << "  if ((preprocess && !p" << index << "_." << proc_class <<
+      "::preprocess()) ||\n";
+    c << "        !p" << index << "_." << proc_class <<
+      "::process(preprocess))\n  {\n    return false;\n  }\n";
+  }
+  c << "  return true;\n}\n";
+
+  std::ofstream h_file(header), c_file(base + ".cpp");
+  if (!h_file || !c_file)
+  {
+    std::cerr << "Cannot write '" << base << "'!" << std::endl;
+    return false;
+  }
+  h_file << h.str();
+  c_file << c.str();
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: uvw_gen <workspace.json> <output base> " <<
+      "[-n name] [-i include]... [-t type=class]... [-v type=c++ type]..." <<
+      std::endl;
+    return 1;
+  }
+
+  Generator gen;
+  std::string base(argv[2]);
+  auto slash = base.find_last_of("/\\");
+  gen.name = (slash == std::string::npos)? base : base.substr(slash + 1);
+
+  for (int i = 3; i + 1 < argc; i += 2)
+  {
+    std::string opt(argv[i]), arg(argv[i + 1]);
+    auto eq = arg.find('=');
+    if (opt == "-n")
+    {
+      gen.name = arg;
+    }
+    else if (opt == "-i")
+    {
+      gen.includes.push_back(arg);
+    }
+    else if ((opt == "-t" || opt == "-v") && eq != std::string::npos)
+    {
+      (opt == "-t"? gen.proc_types : gen.var_types)[arg.substr(0, eq)] =
+        arg.substr(eq + 1);
+    }
+    else
+    {
+      std::cerr << "Invalid option '" << opt << " " << arg << "'!" << std::endl;
+      return 1;
+    }
+  }
+
+  std::ifstream file(argv[1]);
+  if (!file)
+  {
+    std::cerr << "Cannot read '" << argv[1] << "'!" << std::endl;
+    return 1;
+  }
+  std::stringstream buf;
+  buf << file.rdbuf();
+
+  json data;
+  std::string err = picojson::parse(data, buf.str());
+  if (!err.empty())
+  {
+    std::cerr << err << std::endl;
+    return 1;
+  }
+  gen.source = data.serialize();
+
+  return (gen.load(data) && gen.write(base))? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// uvw_load: load generator for a workspace execution server
+//
+//   uvw_load <socket path> <request json> [-c clients] [-n requests]
+//
+// sends the request (a json string, or @file to read it from a file) from
+// each client connection in a closed loop & reports throughput, latency
+// percentiles & how the server batched the requests (see uvw/server.h)
+
+#include <uvw.h>
+#include <uvw/server.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool roundtrip(uvw::SocketTransport& t, const std::string& req,
+  std::string& reply)
+{
+  std::vector<char> msg(req.begin(), req.end());
+  if (!t.send(msg) || !t.recv(msg))
+  {
+    return false;
+  }
+  reply.assign(msg.begin(), msg.end());
+  return true;
+}
+
+static bool stats(const std::string& path, json& res)
+{
+  uvw::SocketTransport t;
+  std::string reply;
+  return (
+    t.connect(path) &&
+    roundtrip(t, "{\"stats\":true}", reply) &&
+    picojson::parse(res, reply).empty() &&
+    res.is<json::object>()
+  );
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cerr << "usage: uvw_load <socket path> <request json> " <<
+      "[-c clients] [-n requests]" << std::endl;
+    return 1;
+  }
+  std::string path = argv[1];
+  std::string req = argv[2];
+  size_t clients = 4, requests = 10000;
+  for (int i = 3; i + 1 < argc; i += 2)
+  {
+    std::string opt = argv[i];
+    if (opt == "-c")
+    {
+      clients = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+    else if (opt == "-n")
+    {
+      requests = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+    else
+    {
+      std::cerr << "Unknown option '" << opt << "'!" << std::endl;
+      return 1;
+    }
+  }
+  if (req.size() && req[0] == '@')
+  {
+    std::ifstream file(req.substr(1));
+    std::stringstream ss;
+    ss << file.rdbuf();
+    req = ss.str();
+  }
+
+  json before, after;
+  if (!clients || !stats(path, before))
+  {
+    std::cerr << "Cannot connect to '" << path << "'!" << std::endl;
+    return 1;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  std::vector<std::vector<double> > latencies(clients);
+  std::vector<size_t> failures(clients, 0);
+  std::vector<std::thread> threads;
+  auto start = Clock::now();
+  for (size_t c = 0; c < clients; c++)
+  {
+    threads.emplace_back([&, c]()
+      {
+        uvw::SocketTransport t;
+        if (!t.connect(path))
+        {
+          failures[c] = requests;
+          return;
+        }
+        std::string reply;
+        latencies[c].reserve(requests);
+        for (size_t i = 0; i < requests; i++)
+        {
+          auto t0 = Clock::now();
+          if (!roundtrip(t, req, reply))
+          {
+            failures[c] += requests - i;
+            return;
+          }
+          latencies[c].push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - t0)
+              .count());
+          if (reply.find("\"ok\":true") == std::string::npos)
+          {
+            failures[c]++;
+          }
+        }
+      }
+    );
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> all;
+  size_t failed = 0;
+  for (size_t c = 0; c < clients; c++)
+  {
+    all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+    failed += failures[c];
+  }
+  if (all.empty())
+  {
+    std::cerr << "No requests completed!" << std::endl;
+    return 1;
+  }
+  std::sort(all.begin(), all.end());
+  auto pct = [&all](double p)
+  {
+    return all[std::min(all.size() - 1, (size_t)(p * all.size()))];
+  };
+
+  std::cout << clients << " clients, " << all.size() << " requests in " <<
+    secs << " s: " << all.size() / secs << " req/s" << std::endl;
+  std::cout << "latency us: p50 " << pct(0.5) << ", p90 " << pct(0.9) <<
+    ", p99 " << pct(0.99) << ", p99.9 " << pct(0.999) << ", max " <<
+    all.back() << std::endl;
+  if (stats(path, after))
+  {
+    auto count = [](json& s, const std::string& key)
+    {
+      return s.get<json::object>()[key].get<int64_t>();
+    };
+    int64_t served = count(after, "requests") - count(before, "requests");
+    std::cout << "server: " << served << " requests in " <<
+      count(after, "runs") - count(before, "runs") << " runs & " <<
+      count(after, "batches") - count(before, "batches") << " batches" <<
+      std::endl;
+  }
+  if (failed)
+  {
+    std::cerr << failed << " requests failed!" << std::endl;
+  }
+  return failed? 1 : 0;
+}